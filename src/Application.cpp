@@ -33,6 +33,8 @@ void Application::Quit()
 	if (window != nullptr)
 	{
 		delete spectrogram;
+		delete capture;
+		delete stream;
 
 		manager.Clear();
 
@@ -44,7 +46,7 @@ void Application::Quit()
 	glfwTerminate();
 }
 
-void Application::Init(int width, int height, const std::string& title)
+void Application::Init(int width, int height, const std::string& title, InputMode input)
 {
 	// Initialize GLFW
 	if (window == nullptr)
@@ -147,12 +149,45 @@ void Application::Init(int width, int height, const std::string& title)
 	data.camera = &camera;
 	data.aspectRatio = (float)width / (float)height;
 
-	spectrogram = new Spectrogram(
-		manager,
-		glm::vec2(5.0f, 5.0f),
-		glm::uvec2(200, 2000),
-		AudioFile("res/payday.wav")
-	);
+	SpectrogramSettings settings;
+	settings.precompute = true;
+	settings.cacheDirectory = "cache";
+	settings.storage = TextureStorage::Half;
+
+	if (input == InputMode::Capture)
+	{
+		capture = new CaptureSource();
+		spectrogram = new Spectrogram(
+			manager,
+			glm::vec2(5.0f, 5.0f),
+			glm::uvec2(200, 2000),
+			*capture,
+			settings
+		);
+
+		capture->Start();
+	}
+	else if (input == InputMode::Stream)
+	{
+		stream = new StreamingSource("res/payday.wav");
+		spectrogram = new Spectrogram(
+			manager,
+			glm::vec2(5.0f, 5.0f),
+			glm::uvec2(200, 2000),
+			*stream,
+			settings
+		);
+	}
+	else
+	{
+		spectrogram = new Spectrogram(
+			manager,
+			glm::vec2(5.0f, 5.0f),
+			glm::uvec2(200, 2000),
+			AudioFile("res/payday.wav"),
+			settings
+		);
+	}
 
 	colormap = 3;
 	spectrogram->SetColormap(colormaps[colormap]);
@@ -160,16 +195,18 @@ void Application::Init(int width, int height, const std::string& title)
 	// glEnable(GL_CULL_FACE);
 	glEnable(GL_MULTISAMPLE);
 
-	frameTimerStart = std::chrono::system_clock::now();
+	scheduler = ColumnScheduler(spectrogram->GetHopSize());
+	frameTimerStart = std::chrono::steady_clock::now();
 }
 
 void Application::Launch()
 {
 	while (!glfwWindowShouldClose(window))
 	{
-		unsigned int frametime = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::system_clock::now() - frameTimerStart).count();
-		frameTimerStart = std::chrono::system_clock::now();
-		float fps = 1000.0f / frametime;
+		std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+		double frametime = std::chrono::duration<double>(now - frameTimerStart).count();
+		frameTimerStart = now;
+		float fps = (float)(1.0 / frametime);
 
 		glfwPollEvents();
 	
@@ -177,8 +214,26 @@ void Application::Launch()
 
 		spectrogram->SetHeightMapping(enableHeightMap);
 		spectrogram->SetColorMapping(enableColorMap);
-		if(enableScroll)
-			spectrogram->Update();
+		// Only the columns the audio clock says are due, all in one upload.
+		// Live input can't be paused, so it is always scheduled
+		size_t due = 0;
+		if(capture)
+		{
+			due = scheduler.Advance(capture->GetCapturedFrames());
+		}
+		else if(enableScroll)
+		{
+			playbackTime += frametime;
+			due = scheduler.Advance((uint64_t)(playbackTime * spectrogram->GetSampleRate()));
+		}
+
+		// Columns the scheduler gave up on are skipped in the input as well,
+		// so the next ones line up with the clock again
+		if((capture || enableScroll) && scheduler.GetSkipped() > 0)
+			spectrogram->Skip(scheduler.GetSkipped());
+
+		if(due > 0)
+			spectrogram->Update(due);
 
 		if(orthogonal)
 			camera.SetOrthogonal(-width / 2.0f * data.aspectRatio, width / 2.0f * data.aspectRatio, -width / 2.0, width / 2.0f, -1.0f, 100.0f);
@@ -197,6 +252,9 @@ void Application::Launch()
 		ImGui::Begin("Debug");
 
 		ImGui::Text("FPS: %f", fps);
+		ImGui::Text("Column backlog: %llu", (unsigned long long)scheduler.GetBacklog());
+		ImGui::Text("Skipped columns: %llu", (unsigned long long)scheduler.GetTotalSkipped());
+		ImGui::Text("Deferred uploads: %llu", (unsigned long long)spectrogram->GetDeferredUploads());
 
 		if (ImGui::CollapsingHeader("Camera"))
 		{
@@ -229,6 +287,19 @@ void Application::Launch()
 			spectrogram->SetColormap(colormaps[colormap]);
 		}
 
+		if(capture && ImGui::CollapsingHeader("Input"))
+		{
+			ImGui::Text("Buffered: %zu frames", capture->GetAvailable());
+			ImGui::Text("Overruns: %llu frames", (unsigned long long)capture->GetOverruns());
+			ImGui::Text("Underruns: %llu", (unsigned long long)capture->GetUnderruns());
+		}
+
+		if(stream && ImGui::CollapsingHeader("Input"))
+		{
+			ImGui::Text("Position: %llu / %llu frames", (unsigned long long)stream->GetPosition(), (unsigned long long)stream->GetFrameCount());
+			ImGui::Text("Read-ahead stalls: %llu", (unsigned long long)stream->GetStalls());
+		}
+
 		ImGui::End();
 
 		ImGui::Render();
@@ -5,9 +5,17 @@
 #include "Util.hpp"
 #include "OrbitingCamera.hpp"
 #include "Spectrogram.hpp"
+#include "ColumnScheduler.hpp"
 
 struct GLFWwindow;
 
+enum class InputMode
+{
+	File,		// Mapped and normalized up front
+	Stream,		// Read in chunks while it plays, for recordings of any length
+	Capture		// The default recording device
+};
+
 struct WindowData
 {
 	OrbitingCamera* camera;
@@ -37,7 +45,7 @@ private:
 /////////////////////////////////////////////////////////
 
 public:
-	void Init(int width, int height, const std::string& title);
+	void Init(int width, int height, const std::string& title, InputMode input = InputMode::File);
 	void Quit();
 	void Launch();
 
@@ -45,7 +53,12 @@ private:
 	GLFWwindow* window = nullptr;
 	WindowData data;
 	lol::ObjectManager manager;
-	std::chrono::system_clock::time_point frameTimerStart;
+	std::chrono::steady_clock::time_point frameTimerStart;
+
+	// Columns follow the audio clock: the captured frames for live input,
+	// the time spent scrolling for the file
+	ColumnScheduler scheduler = ColumnScheduler(1);
+	double playbackTime = 0.0;
 
 	OrbitingCamera camera;
 	float pitch, yaw, distance;
@@ -59,4 +72,6 @@ private:
 	int colormap = 0;
 
 	Spectrogram* spectrogram;
+	CaptureSource* capture = nullptr;
+	StreamingSource* stream = nullptr;
 };
\ No newline at end of file
@@ -1,45 +1,150 @@
 #include "AudioFile.hpp"
 
+#include <algorithm>
+#include <cmath>
 #include <iostream>
+#include <stdexcept>
+
+#include "Hash.hpp"
 
 AudioFile::AudioFile(const std::string& path)
 {
-    // Load the file from disk
-    uint8_t* tempBuf = nullptr;
-    if(SDL_LoadWAV(path.c_str(), &spec, &tempBuf, &length) == NULL)
+    // Map the file, the samples stay on disk until they are read
+    try
+    {
+        wav = std::make_shared<const WavFile>(path);
+    }
+    catch(const std::runtime_error& e)
     {
-        std::cerr << "Failed to load audio file \"" << path << "\": " << SDL_GetError() << std::endl;
+        std::cerr << "Failed to load audio file \"" << path << "\": " << e.what() << std::endl;
         return;
     }
 
-    // Copy raw audio buffer over into vector
-    // Perform conversion to float if necessary
-    unsigned int sampleSize = SDL_AUDIO_BITSIZE(spec.format);
-    bool isFloat = SDL_AUDIO_ISFLOAT(spec.format);
-    for(uint8_t* ptr = tempBuf; ptr < tempBuf + length; ptr += sampleSize)
+    const PcmView& pcm = wav->GetPcm();
+    frames = pcm.frames;
+
+    // Reads always hand out floats
+    spec.freq = (int)wav->GetSampleRate();
+    spec.channels = (Uint8)std::min(pcm.channels, 255u);
+    spec.format = AUDIO_F32SYS;
+    length = frames * pcm.channels * sizeof(float);
+}
+
+AudioFile::AudioFile(const std::vector<float>& samples, const SDL_AudioSpec& spec) :
+    AudioFile(SampleStore::Create(samples, spec.channels, (unsigned int)std::max(spec.freq, 0)))
+{
+    // Keep the rest of the caller's spec, e.g. the buffer size of a device
+    Uint8 channels = this->spec.channels;
+    this->spec = spec;
+    this->spec.format = AUDIO_F32SYS;
+    this->spec.channels = channels;
+}
+
+AudioFile::AudioFile(const std::shared_ptr<const SampleStore>& samples) :
+    samples(samples)
+{
+    frames = samples->GetFrameCount();
+
+    spec.freq = (int)samples->GetSampleRate();
+    spec.channels = (Uint8)std::min(samples->GetChannels(), 255u);
+    spec.format = AUDIO_F32SYS;
+    length = frames * samples->GetChannels() * sizeof(float);
+}
+
+void AudioFile::Read(uint64_t firstFrame, size_t count, float* output) const
+{
+    if(wav)
     {
-        if(isFloat)
-            buffer.push_back(*((float*)ptr));
-        else
-            buffer.push_back((float)*ptr);
+        ConvertPcm(wav->GetPcm(), firstFrame, count, output);
     }
+    else if(samples)
+    {
+        FrameView view = samples->GetFrames(firstFrame, count);
+        std::copy(view.data, view.data + view.GetSamples(), output);
+    }
+}
 
-    // Free the audio buffer
-    SDL_FreeWAV(tempBuf);
+FrameView AudioFile::GetView(uint64_t firstFrame, size_t count) const
+{
+    if(samples)
+        return samples->GetFrames(firstFrame, count);
+
+    if(!wav)
+        return FrameView();
+
+    // Float WAVs can be read from the mapping directly, if their data chunk
+    // happens to be aligned
+    static const uint16_t probe = 1;
+    bool hostBigEndian = (*reinterpret_cast<const uint8_t*>(&probe) == 0);
+
+    const PcmView& pcm = wav->GetPcm();
+    if(pcm.format != SampleFormat::F32 || pcm.bigEndian != hostBigEndian ||
+        reinterpret_cast<uintptr_t>(pcm.data) % alignof(float) != 0 || firstFrame >= pcm.frames)
+    {
+        return FrameView();
+    }
+
+    FrameView all{ pcm.As<float>(), pcm.channels, (size_t)pcm.frames };
+    return all.Slice((size_t)firstFrame, (size_t)std::min<uint64_t>(count, pcm.frames - firstFrame));
 }
 
-AudioFile::~AudioFile()
+const float* AudioFile::GetFrames(uint64_t firstFrame, size_t count, float* buffer) const
 {
-    
+    FrameView view = GetView(firstFrame, count);
+    if(view.frames == count)
+        return view.data;
+
+    Read(firstFrame, count, buffer);
+    return buffer;
+}
+
+std::shared_ptr<const SampleStore> AudioFile::Decode() const
+{
+    std::vector<float> decoded((size_t)frames * spec.channels);
+    Read(0, (size_t)frames, decoded.data());
+
+    return SampleStore::Create(std::move(decoded), spec.channels, (unsigned int)spec.freq);
 }
 
 void AudioFile::Normalize()
 {
-    float largestVal = 0.0f;
-    for(const float& sample : buffer)
-        largestVal = std::max(largestVal, std::abs(sample));
-    
-    float normFactor = 1.0f / largestVal;
-    for(float& sample : buffer)
-        sample *= normFactor;
+    // Convert in blocks, so the peak is found without a copy of the whole file.
+    // Float samples are measured where they are
+    const size_t blockFrames = 4096;
+    std::vector<float> block(blockFrames * spec.channels);
+
+    gain = 1.0f;
+    statistics = SignalStatistics();
+    for(uint64_t first = 0; first < frames; first += blockFrames)
+    {
+        size_t count = (size_t)std::min<uint64_t>(blockFrames, frames - first);
+        statistics.Add(GetFrames(first, count, block.data()), count * spec.channels);
+    }
+
+    if(statistics.peak > 0.0f)
+        gain = 1.0f / statistics.peak;
+}
+
+uint64_t AudioFile::GetContentHash() const
+{
+    uint64_t hash = 0;
+    if(wav)
+    {
+        const PcmView& pcm = wav->GetPcm();
+        uint32_t layout[3] = { (uint32_t)pcm.format, (uint32_t)pcm.bigEndian, pcm.channels };
+
+        hash = HashBytes(layout, sizeof(layout));
+        hash = HashBytes(pcm.data, (size_t)(pcm.frames * pcm.GetFrameSize()), hash);
+    }
+    else if(samples)
+    {
+        uint32_t layout[3] = { (uint32_t)SampleFormat::F32, 0, spec.channels };
+
+        FrameView view = samples->GetFrames();
+        hash = HashBytes(layout, sizeof(layout));
+        hash = HashBytes(view.data, view.GetSamples() * sizeof(float), hash);
+    }
+
+    uint32_t rate = (uint32_t)spec.freq;
+    return HashBytes(&rate, sizeof(rate), hash);
 }
\ No newline at end of file
@@ -2,26 +2,71 @@
 
 #include <string>
 #include <cstdint>
+#include <memory>
 #include <vector>
 
 #include <SDL2/SDL_audio.h>
 
+#include "WavFile.hpp"
+#include "SampleStore.hpp"
+#include "GainControl.hpp"
+
+// Audio that is either mapped from a WAV file or held in memory. Mapped files
+// are never converted as a whole, Read() converts just the requested frames,
+// so opening even hour long recordings is instant. Either way the samples are
+// shared, so copies of an AudioFile never copy the signal.
 class AudioFile
 {
 public:
     AudioFile(const std::string& path);
-    ~AudioFile();
+    AudioFile(const std::vector<float>& samples, const SDL_AudioSpec& spec);
+    AudioFile(const std::shared_ptr<const SampleStore>& samples);
+
+    inline const SDL_AudioSpec& GetAudioSpec() const { return spec; }
+    inline uint64_t GetLength() const { return length; }
+
+    inline uint64_t GetFrameCount() const { return frames; }
+    inline unsigned int GetChannels() const { return spec.channels; }
+
+    // Writes count interleaved frames from firstFrame on. Safe to call from
+    // several threads at once
+    void Read(uint64_t firstFrame, size_t count, float* output) const;
 
-    inline std::vector<float>::const_iterator begin() const { return buffer.begin(); }
-    inline std::vector<float>::const_iterator end() const { return buffer.end(); }
+    // The same frames without a copy, straight from the store or the mapping.
+    // Only possible for samples that are already floats in host order,
+    // otherwise the view is empty and Read() has to be used
+    FrameView GetView(uint64_t firstFrame, size_t count) const;
 
-    inline const SDL_AudioSpec& GetAudioSpec() { return spec; }
-    inline uint32_t GetLength() { return length; }
+    // The frames as a view if there is one, converted into buffer otherwise.
+    // Returns wherever they ended up
+    const float* GetFrames(uint64_t firstFrame, size_t count, float* buffer) const;
 
+    // Converts the whole signal into a store once. An AudioFile made from it
+    // hands out views for every frame
+    std::shared_ptr<const SampleStore> Decode() const;
+
+    // Finds the gain that brings the loudest sample to 1. A single pass over
+    // the file that also gathers GetStatistics(). The samples themselves are
+    // never scaled, so the views stay valid. Anything linear in the signal,
+    // like a magnitude spectrum, applies GetGain() afterwards instead
     void Normalize();
+    inline float GetGain() const { return gain; }
+
+    // Hash of the samples as stored and their layout, independent of the
+    // gain. Reads every sample once
+    uint64_t GetContentHash() const;
+
+    // Peak and RMS of the unscaled samples, valid after Normalize()
+    inline const SignalStatistics& GetStatistics() const { return statistics; }
 
 private:
-    SDL_AudioSpec spec;
-    uint32_t length;
-    std::vector<float> buffer;
+    SDL_AudioSpec spec = {};
+    uint64_t length = 0;
+    uint64_t frames = 0;
+    float gain = 1.0f;
+    SignalStatistics statistics;
+
+    // Shared, so copies don't map the file again
+    std::shared_ptr<const WavFile> wav;
+    std::shared_ptr<const SampleStore> samples;
 };
\ No newline at end of file
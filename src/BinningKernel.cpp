@@ -0,0 +1,124 @@
+#include "BinningKernel.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+// Conversions between Hz and the warped frequency axes
+static double ToScale(FrequencyScale scale, double hz)
+{
+    switch(scale)
+    {
+    case FrequencyScale::Logarithmic:   return std::log(hz);
+    case FrequencyScale::Mel:           return 2595.0 * std::log10(1.0 + hz / 700.0);
+    case FrequencyScale::Bark:          return 26.81 * hz / (1960.0 + hz) - 0.53;      // Traunmueller
+    default:                            return hz;
+    }
+}
+
+static double FromScale(FrequencyScale scale, double value)
+{
+    switch(scale)
+    {
+    case FrequencyScale::Logarithmic:   return std::exp(value);
+    case FrequencyScale::Mel:           return 700.0 * (std::pow(10.0, value / 2595.0) - 1.0);
+    case FrequencyScale::Bark:          return 1960.0 * (value + 0.53) / (26.28 - value);
+    default:                            return value;
+    }
+}
+
+BinningKernel::BinningKernel(FrequencyScale scale, size_t fftSize, float sampleRate, size_t rows, float minFreq, float maxFreq)
+{
+    if(rows < 2 || minFreq <= 0.0f || maxFreq <= minFreq)
+        throw std::runtime_error("Invalid frequency range for binning kernel");
+
+    size_t bins = fftSize / 2 + 1;
+    double binWidth = (double)sampleRate / (double)fftSize;
+
+    double first = ToScale(scale, minFreq);
+    double step = (ToScale(scale, maxFreq) - first) / (double)(rows - 1);
+
+    spans.reserve(rows);
+    for(size_t row = 0; row < rows; row++)
+    {
+        double center = FromScale(scale, first + step * (double)row);
+        double lower = FromScale(scale, first + step * ((double)row - 1.0));
+        double upper = FromScale(scale, first + step * ((double)row + 1.0));
+
+        // Keep every filter at least one bin wide, so that rows narrower than
+        // a bin interpolate between their two closest bins
+        lower = std::min(lower, center - binWidth);
+        upper = std::max(upper, center + binWidth);
+
+        AddTriangle(lower, center, upper, binWidth, bins);
+    }
+}
+
+void BinningKernel::Apply(const float* spectrum, float* output) const
+{
+    kernels->SparseMultiply(spans.data(), spans.size(), weights.data(), spectrum, output);
+}
+
+void BinningKernel::Scale(float factor)
+{
+    for(float& weight : weights)
+        weight *= factor;
+}
+
+std::vector<size_t> BinningKernel::GetUsedBins() const
+{
+    std::vector<size_t> used;
+    for(const SparseSpan& span : spans)
+    {
+        for(uint32_t i = 0; i < span.length; i++)
+            used.push_back(span.start + i);
+    }
+
+    std::sort(used.begin(), used.end());
+    used.erase(std::unique(used.begin(), used.end()), used.end());
+
+    return used;
+}
+
+void BinningKernel::AddTriangle(double lower, double center, double upper, double binWidth, size_t bins)
+{
+    long long first = (long long)std::ceil(lower / binWidth);
+    long long last = (long long)std::floor(upper / binWidth);
+
+    first = std::max(first, 0LL);
+    last = std::min(last, (long long)bins - 1);
+
+    SparseSpan span = { 0, 0, (uint32_t)weights.size() };
+    double sum = 0.0;
+
+    for(long long k = first; k <= last; k++)
+    {
+        // Bins exactly on the edge of the triangle don't contribute
+        double freq = k * binWidth;
+        double weight = (freq < center) ? (freq - lower) / (center - lower) : (upper - freq) / (upper - center);
+        if(weight <= 0.0)
+            continue;
+
+        if(span.length == 0)
+            span.start = (uint32_t)k;
+
+        weights.push_back((float)weight);
+        span.length++;
+        sum += weight;
+    }
+
+    // Rows outside the spectrum fall back to the closest bin
+    if(span.length == 0)
+    {
+        long long nearest = std::min(std::max((long long)std::llround(center / binWidth), 0LL), (long long)bins - 1);
+        span.start = (uint32_t)nearest;
+        span.length = 1;
+        weights.push_back(1.0f);
+        sum = 1.0;
+    }
+
+    for(size_t i = span.offset; i < weights.size(); i++)
+        weights[i] = (float)(weights[i] / sum);
+
+    spans.push_back(span);
+}
\ No newline at end of file
@@ -0,0 +1,51 @@
+#pragma once
+
+#include <vector>
+
+#include "Simd.hpp"
+
+enum class FrequencyScale
+{
+    Linear,
+    Logarithmic,
+    Mel,
+    Bark
+};
+
+// Maps a magnitude spectrum onto the rows of an image. The row centers are
+// spaced evenly on the chosen scale, and each row is a normalized triangular
+// filter that reaches from the previous to the next row's center. That makes
+// the mel and Bark scales the usual triangular filterbanks. The filters are
+// stored as a sparse matrix with one contiguous span per row. Building the
+// kernel does all the searching, applying it is a multiply-accumulate over
+// the non-zeros.
+class BinningKernel
+{
+public:
+    BinningKernel() = default;
+
+    // fftSize is the size of the transform whose fftSize/2 + 1 bins are mapped.
+    // The rows are spaced evenly on the given scale between minFreq and maxFreq
+    BinningKernel(FrequencyScale scale, size_t fftSize, float sampleRate, size_t rows, float minFreq, float maxFreq);
+
+    void Apply(const float* spectrum, float* output) const;
+
+    // Scales every filter, e.g. to apply a gain of the signal to the rows
+    // instead, which the transforms and filters being linear allows
+    void Scale(float factor);
+
+    // All bins at least one row reads from
+    std::vector<size_t> GetUsedBins() const;
+
+    inline size_t GetRows() const { return spans.size(); }
+    inline size_t GetNonZeros() const { return weights.size(); }
+
+private:
+    // Appends a row with a triangle from lower over center to upper (in Hz)
+    void AddTriangle(double lower, double center, double upper, double binWidth, size_t bins);
+
+private:
+    std::vector<SparseSpan> spans;
+    std::vector<float> weights;
+    const SimdKernels* kernels = &GetSimdKernels();
+};
\ No newline at end of file
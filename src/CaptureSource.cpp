@@ -0,0 +1,74 @@
+#include "CaptureSource.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+
+#include <SDL2/SDL.h>
+
+CaptureSource::CaptureSource(const std::string& device, int sampleRate, unsigned int channels, size_t bufferFrames) :
+    ring(bufferFrames * channels), captured(0), overruns(0), underruns(0)
+{
+    if(!SDL_WasInit(SDL_INIT_AUDIO) && SDL_InitSubSystem(SDL_INIT_AUDIO) != 0)
+        throw std::runtime_error(std::string("Failed to initialize SDL audio: ") + SDL_GetError());
+
+    SDL_AudioSpec desired = {};
+    desired.freq = sampleRate;
+    desired.format = AUDIO_F32SYS;
+    desired.channels = (Uint8)channels;
+    desired.samples = 1024;
+    desired.callback = &CaptureSource::Callback;
+    desired.userdata = this;
+
+    // No allowed changes, SDL converts whatever the device delivers to the
+    // desired format, so the callback only ever copies
+    this->device = SDL_OpenAudioDevice(device.empty() ? nullptr : device.c_str(), 1, &desired, &spec, 0);
+    if(this->device == 0)
+        throw std::runtime_error(std::string("Failed to open capture device: ") + SDL_GetError());
+}
+
+CaptureSource::~CaptureSource()
+{
+    if(device != 0)
+        SDL_CloseAudioDevice(device);
+}
+
+void CaptureSource::Start()
+{
+    SDL_PauseAudioDevice(device, 0);
+}
+
+void CaptureSource::Stop()
+{
+    SDL_PauseAudioDevice(device, 1);
+}
+
+bool CaptureSource::Read(float* frames, size_t count)
+{
+    size_t samples = count * spec.channels;
+    if(ring.GetReadable() < samples)
+    {
+        underruns.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+
+    ring.Read(frames, samples);
+    return true;
+}
+
+// Runs on SDL's audio thread, must neither block nor allocate
+void CaptureSource::Callback(void* userdata, Uint8* stream, int length)
+{
+    CaptureSource* source = static_cast<CaptureSource*>(userdata);
+
+    // Only whole frames go in, so the consumer never sees a torn frame
+    size_t channels = source->spec.channels;
+    size_t frames = (size_t)length / sizeof(float) / channels;
+    size_t writable = source->ring.GetWritable() / channels;
+    size_t written = std::min(frames, writable);
+
+    source->ring.Write(reinterpret_cast<const float*>(stream), written * channels);
+    source->captured.fetch_add(written, std::memory_order_release);
+
+    if(written < frames)
+        source->overruns.fetch_add(frames - written, std::memory_order_relaxed);
+}
\ No newline at end of file
@@ -0,0 +1,61 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+
+#include <SDL2/SDL_audio.h>
+
+#include "RingBuffer.hpp"
+
+// Live input from an SDL capture device. SDL's audio thread writes into a
+// lock-free ring buffer, the analysis drains it without locking. Frames are
+// interleaved floats.
+//
+// Works with any SDL audio driver, including the "disk" driver (reads raw
+// samples from SDL_DISKAUDIOFILEIN) and the "dummy" driver, so it runs
+// without sound hardware.
+class CaptureSource
+{
+public:
+    // An empty device name opens the default device. The ring holds
+    // bufferFrames frames before the callback starts dropping input.
+    // Throws std::runtime_error if the device can't be opened
+    CaptureSource(const std::string& device = "", int sampleRate = 48000, unsigned int channels = 2, size_t bufferFrames = 1 << 16);
+    ~CaptureSource();
+
+    CaptureSource(const CaptureSource& other) = delete;
+    CaptureSource& operator=(const CaptureSource& other) = delete;
+
+    void Start();
+    void Stop();
+
+    // Reads exactly count frames, or nothing and counts an underrun if fewer are buffered
+    bool Read(float* frames, size_t count);
+    inline size_t GetAvailable() const { return ring.GetReadable() / spec.channels; }
+
+    inline const SDL_AudioSpec& GetAudioSpec() const { return spec; }
+    inline unsigned int GetChannels() const { return spec.channels; }
+
+    // Frames that went into the ring since the device was opened. Only ever
+    // grows, so it doubles as the audio clock of the live input
+    inline uint64_t GetCapturedFrames() const { return captured.load(std::memory_order_acquire); }
+
+    // Frames the callback dropped because the ring was full
+    inline uint64_t GetOverruns() const { return overruns.load(std::memory_order_relaxed); }
+
+    // Reads that found fewer frames than requested
+    inline uint64_t GetUnderruns() const { return underruns.load(std::memory_order_relaxed); }
+
+private:
+    static void Callback(void* userdata, Uint8* stream, int length);
+
+private:
+    SDL_AudioDeviceID device = 0;
+    SDL_AudioSpec spec = {};
+
+    RingBuffer ring;
+    std::atomic<uint64_t> captured;
+    std::atomic<uint64_t> overruns;
+    std::atomic<uint64_t> underruns;
+};
\ No newline at end of file
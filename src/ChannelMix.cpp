@@ -0,0 +1,35 @@
+#include "ChannelMix.hpp"
+
+std::vector<ChannelMix> MakeChannelMixes(ChannelView view, size_t channels)
+{
+    std::vector<ChannelMix> mixes;
+    ChannelMix mix;
+    mix.channels = channels;
+
+    if(view == ChannelView::Separate && channels > 1)
+    {
+        for(size_t c = 0; c < channels; c++)
+        {
+            mix.weights.assign(channels, 0.0f);
+            mix.weights[c] = 1.0f;
+            mixes.push_back(mix);
+        }
+    }
+    else if(view == ChannelView::MidSide && channels > 1)
+    {
+        mix.weights.assign(channels, 0.0f);
+        mix.weights[0] = mix.weights[1] = 0.5f;
+        mixes.push_back(mix);
+
+        mix.weights[1] = -0.5f;
+        mixes.push_back(mix);
+    }
+    else
+    {
+        // Mono files end up here for every view
+        mix.weights.assign(channels, 1.0f / (float)channels);
+        mixes.push_back(mix);
+    }
+
+    return mixes;
+}
\ No newline at end of file
@@ -0,0 +1,32 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+enum class ChannelView
+{
+    Mixdown,        // Average of all channels
+    Separate,       // Every channel on its own
+    MidSide         // (L + R) / 2 and (L - R) / 2 of the first two channels
+};
+
+// Derives the analyzed signal from interleaved audio as a weighted sum of the
+// channels of each frame. Analyzers apply it while loading their input, so
+// deinterleaving never needs its own pass or buffer.
+struct ChannelMix
+{
+    size_t channels = 1;
+    std::vector<float> weights = { 1.0f };
+
+    inline float Apply(const float* frame) const
+    {
+        float value = 0.0f;
+        for(size_t c = 0; c < channels; c++)
+            value += weights[c] * frame[c];
+
+        return value;
+    }
+};
+
+// One mix per analyzed signal of the view
+std::vector<ChannelMix> MakeChannelMixes(ChannelView view, size_t channels);
\ No newline at end of file
@@ -0,0 +1,43 @@
+#include "ColumnScheduler.hpp"
+
+#include <algorithm>
+
+ColumnScheduler::ColumnScheduler(size_t hopSize, size_t maxBatch) :
+    hopSize(std::max<size_t>(hopSize, 1)), maxBatch(std::max<size_t>(maxBatch, 1))
+{
+}
+
+size_t ColumnScheduler::Advance(uint64_t clock)
+{
+    // A clock running backwards would mean the source restarted or seeked
+    if(clock < last)
+        Reset(clock);
+
+    last = clock;
+
+    uint64_t target = (clock - origin) / hopSize;
+    uint64_t due = (target > scheduled) ? target - scheduled : 0;
+
+    // With small hops more columns can come due per frame than a batch
+    // holds. Keeping them all would let the image fall ever further behind,
+    // so only the newest batch beyond this one stays due
+    skipped = (due > 2 * (uint64_t)maxBatch) ? due - 2 * (uint64_t)maxBatch : 0;
+    totalSkipped += skipped;
+    due -= skipped;
+
+    size_t batch = (size_t)std::min<uint64_t>(due, maxBatch);
+    scheduled += skipped + batch;
+    backlog = due - batch;
+
+    return batch;
+}
+
+void ColumnScheduler::Reset(uint64_t clock)
+{
+    origin = clock;
+    last = clock;
+    scheduled = 0;
+    backlog = 0;
+    skipped = 0;
+    totalSkipped = 0;
+}
\ No newline at end of file
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// Decides how many spectrogram columns are due, based on a monotonic audio
+// clock in frames rather than on the frame rate. Late frames get several
+// columns at once, early frames get none, so the image keeps real time at
+// any frame rate.
+class ColumnScheduler
+{
+public:
+    // At most maxBatch columns are handed out per call, anything beyond that
+    // stays due for the next calls instead of stalling a single frame. At most
+    // one more batch is kept due, older columns are skipped
+    ColumnScheduler(size_t hopSize, size_t maxBatch = 64);
+
+    // Columns due at clock, which counts frames since the scheduler started
+    // or was last reset. Every column returned counts as done. A clock that
+    // runs backwards starts over from there, like Reset(clock)
+    size_t Advance(uint64_t clock);
+
+    // Starts over at the given clock position, e.g. after a pause or seek
+    void Reset(uint64_t clock = 0);
+
+    // Columns that are due but weren't handed out yet, never more than a batch
+    inline uint64_t GetBacklog() const { return backlog; }
+
+    // Columns the last Advance() skipped because the backlog was full. They
+    // come before the ones it handed out, so their input has to be skipped
+    // as well to keep the image in step with the clock
+    inline uint64_t GetSkipped() const { return skipped; }
+
+    // All columns skipped since the last reset
+    inline uint64_t GetTotalSkipped() const { return totalSkipped; }
+
+private:
+    size_t hopSize;
+    size_t maxBatch;
+
+    uint64_t origin = 0;
+    uint64_t last = 0;
+    uint64_t scheduled = 0;
+    uint64_t backlog = 0;
+    uint64_t skipped = 0;
+    uint64_t totalSkipped = 0;
+};
\ No newline at end of file
@@ -0,0 +1,93 @@
+#include "Decimator.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+#include "Window.hpp"
+
+// Input samples filtered per step, bounds the size of the delay line
+#define BLOCK_SIZE 4096
+
+Decimator::Decimator(size_t factor, size_t tapsPerFactor, const SimdKernels& kernels) :
+    factor(factor), kernels(&kernels)
+{
+    if(factor == 0 || tapsPerFactor == 0)
+        throw std::runtime_error("Decimation factor and filter length must be non-zero");
+
+    // Kaiser windowed sinc, symmetric around its center
+    size_t length = tapsPerFactor * factor;
+    double cutoff = 0.45 / (double)factor;
+    double beta = 8.6;
+    double center = 0.5 * (double)(length - 1);
+
+    taps.resize(length);
+    double sum = 0.0;
+    for(size_t i = 0; i < length; i++)
+    {
+        double t = (double)i - center;
+        double sinc = (t == 0.0) ? 2.0 * cutoff : std::sin(2.0 * M_PI * cutoff * t) / (M_PI * t);
+        double ratio = (center > 0.0) ? t / center : 0.0;
+        double window = BesselI0(beta * std::sqrt(std::max(0.0, 1.0 - ratio * ratio))) / BesselI0(beta);
+
+        taps[i] = (float)(sinc * window);
+        sum += taps[i];
+    }
+
+    // Unity gain at DC
+    for(float& tap : taps)
+        tap = (float)(tap / sum);
+
+    line.resize(length - 1 + BLOCK_SIZE, 0.0f);
+    spans.resize(BLOCK_SIZE / factor + 1);
+}
+
+size_t Decimator::Process(const float* input, size_t count, float* output)
+{
+    size_t history = taps.size() - 1;
+    size_t outputs = 0;
+
+    while(count > 0)
+    {
+        size_t block = std::min<size_t>(count, BLOCK_SIZE);
+        std::copy(input, input + block, line.begin() + history);
+
+        // An output is due after every factor-th input, the first one of this
+        // block after factor - phase more samples
+        size_t first = factor - 1 - phase;
+        if(first < block)
+        {
+            size_t due = (block - 1 - first) / factor + 1;
+            for(size_t i = 0; i < due; i++)
+                spans[i] = { (uint32_t)(first + i * factor), (uint32_t)taps.size(), 0 };
+
+            kernels->SparseMultiply(spans.data(), due, taps.data(), line.data(), output + outputs);
+            outputs += due;
+        }
+
+        phase = (phase + block) % factor;
+
+        // Keep the tail as the history of the next block
+        std::copy(line.begin() + block, line.begin() + block + history, line.begin());
+
+        input += block;
+        count -= block;
+    }
+
+    return outputs;
+}
+
+void Decimator::ProcessSpan(const float* input, size_t outputs, float* output) const
+{
+    // Same spans as the streamed path, so both produce identical values
+    size_t done = 0;
+    while(done < outputs)
+    {
+        size_t due = std::min(outputs - done, spans.size());
+        for(size_t i = 0; i < due; i++)
+            spans[i] = { (uint32_t)((done + i) * factor), (uint32_t)taps.size(), 0 };
+
+        kernels->SparseMultiply(spans.data(), due, taps.data(), input, output + done);
+        done += due;
+    }
+}
\ No newline at end of file
@@ -0,0 +1,45 @@
+#pragma once
+
+#include <vector>
+
+#include "Simd.hpp"
+
+// Lowpass filters a signal and keeps every factor-th sample. Only the kept
+// outputs are ever computed, which is the polyphase decimator in its direct
+// form: each output is one dot product of the filter with the input span
+// ending at it, run through the SparseMultiply kernel. The filter state
+// carries over between blocks.
+class Decimator
+{
+public:
+    // The windowed-sinc filter has tapsPerFactor * factor taps and cuts off
+    // at 90% of the new Nyquist frequency. With the default length it is flat
+    // up to 70% of it, tones from 1.3 times it on are at least 90 dB down
+    Decimator(size_t factor, size_t tapsPerFactor = 32, const SimdKernels& kernels = GetSimdKernels());
+
+    // Consumes count input samples and writes the outputs that became due.
+    // Returns the number of outputs, at most count / factor + 1
+    size_t Process(const float* input, size_t count, float* output);
+
+    // Filters GetSpan(outputs) contiguous samples into outputs samples, the
+    // last one ending at the last input sample. Ignores the streamed state
+    void ProcessSpan(const float* input, size_t outputs, float* output) const;
+
+    // Input samples that outputs consecutive outputs depend on
+    inline size_t GetSpan(size_t outputs) const { return (outputs - 1) * factor + taps.size(); }
+    inline size_t GetFactor() const { return factor; }
+
+private:
+    size_t factor;
+    const SimdKernels* kernels;
+
+    // Stored in time order, so each output is a plain dot product
+    std::vector<float> taps;
+
+    // The last taps - 1 samples followed by the current block
+    std::vector<float> line;
+    size_t phase = 0;
+
+    // One span per output of a block, all reading the same taps
+    mutable std::vector<SparseSpan> spans;
+};
\ No newline at end of file
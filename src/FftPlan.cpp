@@ -0,0 +1,111 @@
+#include "FftPlan.hpp"
+
+#include <cmath>
+#include <stdexcept>
+
+#define POW_OF_TWO(x) ((x) && !((x) & ((x) - 1)))
+
+FftPlan::FftPlan(size_t N, const SimdKernels& kernels) :
+    N(N), kernels(&kernels)
+{
+    if(!POW_OF_TWO(N))
+        throw std::runtime_error("FFT size must be a power of two");
+
+    unsigned int bits = 0;
+    while(((size_t)1 << bits) < N)
+        bits++;
+
+    bitReversal.resize(N);
+    for(size_t i = 0; i < N; i++)
+    {
+        uint32_t reversed = 0;
+        for(unsigned int b = 0; b < bits; b++)
+            reversed |= ((i >> b) & 1) << (bits - 1 - b);
+
+        bitReversal[i] = reversed;
+    }
+
+    // w^k = exp(-pi*i*k / half), calculated in double precision to keep the
+    // error of the larger transforms down. Laying every stage out contiguously
+    // lets the kernels load the twiddles with plain vector loads
+    twiddles.resize(N > 1 ? N - 1 : 0);
+    for(size_t half = 1; half < N; half <<= 1)
+    {
+        for(size_t k = 0; k < half; k++)
+        {
+            double phi = -M_PI * (double)k / (double)half;
+            twiddles[half - 1 + k] = std::complex<float>((float)std::cos(phi), (float)std::sin(phi));
+        }
+    }
+}
+
+void FftPlan::Transform(const std::complex<float>* input, std::complex<float>* output) const
+{
+    for(size_t i = 0; i < N; i++)
+        output[bitReversal[i]] = input[i];
+
+    Butterflies(output);
+}
+
+void FftPlan::Transform(const float* input, std::complex<float>* output) const
+{
+    for(size_t i = 0; i < N; i++)
+        output[bitReversal[i]] = std::complex<float>(input[i], 0.0f);
+
+    Butterflies(output);
+}
+
+void FftPlan::Butterflies(std::complex<float>* data) const
+{
+    float* values = reinterpret_cast<float*>(data);
+    const float* factors = reinterpret_cast<const float*>(twiddles.data());
+
+    for(size_t half = 1; half < N; half <<= 1)
+        kernels->Butterflies(values, N, half, factors + 2 * (half - 1));
+}
+
+RealFftPlan::RealFftPlan(size_t N, const SimdKernels& kernels) :
+    N(N), half(N / 2, kernels)
+{
+    if(N < 2)
+        throw std::runtime_error("Real FFT size must be at least two");
+
+    splitTwiddles.resize(N / 4 + 1);
+    for(size_t k = 0; k < splitTwiddles.size(); k++)
+    {
+        double phi = -2.0 * M_PI * (double)k / (double)N;
+        splitTwiddles[k] = std::complex<float>((float)std::cos(phi), (float)std::sin(phi));
+    }
+}
+
+void RealFftPlan::Transform(const float* input, std::complex<float>* output) const
+{
+    // Even samples go into the real part, odd samples into the imaginary part
+    size_t M = N / 2;
+    half.Transform(reinterpret_cast<const std::complex<float>*>(input), output);
+
+    std::complex<float> dc = output[0];
+    output[0] = std::complex<float>(dc.real() + dc.imag(), 0.0f);
+    output[M] = std::complex<float>(dc.real() - dc.imag(), 0.0f);
+
+    // Bins k and M - k depend on the same two values, so they are split together
+    for(size_t k = 1; k <= M - k; k++)
+    {
+        std::complex<float> a = output[k];
+        std::complex<float> b = std::conj(output[M - k]);
+
+        std::complex<float> even = 0.5f * (a + b);
+        std::complex<float> odd = 0.5f * (a - b);
+
+        const std::complex<float>& w = splitTwiddles[k];
+        std::complex<float> t(
+            w.real() * odd.real() - w.imag() * odd.imag(),
+            w.real() * odd.imag() + w.imag() * odd.real()
+        );
+
+        // X[k] = even - i*t, X[M - k] = conj(even + i*t)
+        output[k] = std::complex<float>(even.real() + t.imag(), even.imag() - t.real());
+        if(k != M - k)
+            output[M - k] = std::complex<float>(even.real() - t.imag(), -(even.imag() + t.real()));
+    }
+}
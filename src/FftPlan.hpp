@@ -0,0 +1,56 @@
+#pragma once
+
+#include <complex>
+#include <cstdint>
+#include <vector>
+
+#include "Simd.hpp"
+
+// Iterative radix-2 FFT of a fixed power-of-two size. The bit-reversal
+// permutation and the twiddle factors are computed once on construction,
+// the transforms themselves never allocate.
+class FftPlan
+{
+public:
+    FftPlan(size_t N, const SimdKernels& kernels = GetSimdKernels());
+
+    // Transforms N complex samples. input and output must not overlap
+    void Transform(const std::complex<float>* input, std::complex<float>* output) const;
+
+    // Transforms N real samples. input and output must not overlap
+    void Transform(const float* input, std::complex<float>* output) const;
+
+    inline size_t GetSize() const { return N; }
+
+private:
+    void Butterflies(std::complex<float>* data) const;
+
+private:
+    size_t N;
+    const SimdKernels* kernels;
+    std::vector<uint32_t> bitReversal;
+
+    // Twiddles of every stage stored back to back, the stage combining
+    // points half apart starts at index half - 1
+    std::vector<std::complex<float>> twiddles;
+};
+
+// Real-input FFT of a fixed even size N. The N real samples are packed into an
+// N/2 point complex FFT, a split step then recovers the N/2 + 1 non-redundant
+// bins of the real spectrum.
+class RealFftPlan
+{
+public:
+    RealFftPlan(size_t N, const SimdKernels& kernels = GetSimdKernels());
+
+    // Transforms N real samples into N/2 + 1 bins. input and output must not overlap
+    void Transform(const float* input, std::complex<float>* output) const;
+
+    inline size_t GetSize() const { return N; }
+    inline size_t GetBins() const { return N / 2 + 1; }
+
+private:
+    size_t N;
+    FftPlan half;
+    std::vector<std::complex<float>> splitTwiddles;
+};
@@ -0,0 +1,63 @@
+#include "GainControl.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+void SignalStatistics::Add(const float* input, size_t count, const SimdKernels& kernels)
+{
+    float blockPeak, blockSum;
+    kernels.Statistics(input, count, &blockPeak, &blockSum);
+
+    peak = std::max(peak, blockPeak);
+    sumSquares += blockSum;
+    samples += count;
+}
+
+float SignalStatistics::GetRms() const
+{
+    return (samples > 0) ? (float)std::sqrt(sumSquares / (double)samples) : 0.0f;
+}
+
+GainControl::GainControl(const GainControlSettings& settings, float sampleRate, unsigned int channels) :
+    settings(settings), sampleRate(sampleRate), channels(std::max(channels, 1u)), kernels(&GetSimdKernels())
+{
+}
+
+void GainControl::Process(float* frames, size_t count)
+{
+    if(count == 0)
+        return;
+
+    size_t samples = count * channels;
+    float peak, sumSquares;
+    kernels->Statistics(frames, samples, &peak, &sumSquares);
+
+    float level = (settings.detector == LevelDetector::Peak) ? peak : std::sqrt(sumSquares / (float)samples);
+
+    // One step of a one-pole smoother over the whole block, so the time
+    // constants don't depend on the block size
+    float seconds = (float)count / sampleRate;
+    float time = (level > envelope) ? settings.attack : settings.release;
+    float coefficient = (time > 0.0f) ? std::exp(-seconds / time) : 0.0f;
+    envelope = level + coefficient * (envelope - level);
+
+    float target = (envelope > 0.0f) ? std::min(settings.target / envelope, settings.maxGain) : settings.maxGain;
+
+    // The block was measured before it is scaled, so a peak tracker can make
+    // sure it never pushes a sample past the target
+    if(settings.detector == LevelDetector::Peak && peak > 0.0f)
+        target = std::min(target, settings.target / peak);
+
+    // A falling gain applies at once, a rising one ramps up from the previous
+    // gain across the block so it never jumps
+    float start = std::min(gain, target);
+    float step = (target - start) / (float)count;
+    for(size_t i = 0; i < count; i++)
+    {
+        float g = start + step * (float)(i + 1);
+        for(unsigned int c = 0; c < channels; c++)
+            frames[i * channels + c] *= g;
+    }
+
+    gain = target;
+}
\ No newline at end of file
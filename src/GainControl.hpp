@@ -0,0 +1,57 @@
+#pragma once
+
+#include <cstdint>
+
+#include "Simd.hpp"
+
+// Running peak and RMS of a signal, fed block by block as it is decoded
+struct SignalStatistics
+{
+    float peak = 0.0f;
+    double sumSquares = 0.0;
+    uint64_t samples = 0;
+
+    // One SIMD pass over the block. Sums are kept in double across blocks
+    void Add(const float* input, size_t count, const SimdKernels& kernels = GetSimdKernels());
+    float GetRms() const;
+};
+
+enum class LevelDetector
+{
+    Peak,       // Follows the largest sample of each block
+    Rms         // Follows the block's RMS, reacts less to single transients
+};
+
+struct GainControlSettings
+{
+    LevelDetector detector = LevelDetector::Peak;
+    float target = 1.0f;        // Level the signal is scaled to
+    float attack = 0.01f;       // Seconds to follow a rising level by 1 - 1/e
+    float release = 2.0f;       // Seconds to follow a falling level by 1 - 1/e
+    float maxGain = 1000.0f;    // Keeps silence from being amplified into noise
+};
+
+// Streaming automatic gain control. The level is tracked once per block by
+// an attack/release envelope. A falling gain applies to the whole block
+// right away, a rising gain ramps linearly across it. Works on live input of
+// unknown loudness, unlike a whole file normalization.
+class GainControl
+{
+public:
+    GainControl(const GainControlSettings& settings, float sampleRate, unsigned int channels);
+
+    // Scales count interleaved frames in place
+    void Process(float* frames, size_t count);
+
+    inline float GetGain() const { return gain; }
+    inline float GetLevel() const { return envelope; }
+
+private:
+    GainControlSettings settings;
+    float sampleRate;
+    unsigned int channels;
+    const SimdKernels* kernels;
+
+    float envelope = 0.0f;
+    float gain = 1.0f;
+};
\ No newline at end of file
@@ -0,0 +1,9 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// 64 bit xxHash (XXH64) of size bytes. Processes 32 bytes per step, so
+// hashing a whole mapped recording runs at memory speed. The data may be
+// unaligned
+uint64_t HashBytes(const void* data, size_t size, uint64_t seed = 0);
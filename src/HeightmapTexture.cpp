@@ -0,0 +1,111 @@
+#include "HeightmapTexture.hpp"
+
+#include <algorithm>
+#include <glad/glad.h>
+
+HeightmapTexture::HeightmapTexture(unsigned int columns, unsigned int rows, TextureStorage storage, bool stream) :
+    columns(columns), rows(rows)
+{
+    format.storage = storage;
+
+    glGenTextures(1, &texture);
+    glBindTexture(GL_TEXTURE_2D, texture);
+    glTexStorage2D(GL_TEXTURE_2D, 1, format.GetInternalFormat(), rows, columns);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+
+    if(stream)
+        uploader = std::make_unique<PixelUploader>(columns, rows, format.GetSize());
+    else if(storage != TextureStorage::Float)
+        staging.resize((size_t)columns * rows * format.GetSize());
+}
+
+HeightmapTexture::~HeightmapTexture()
+{
+    // The uploader's buffer has to go while the context is still current
+    uploader.reset();
+    glDeleteTextures(1, &texture);
+}
+
+bool HeightmapTexture::SetLogRange(float logMin, float logMax)
+{
+    if(logMin == format.logMin && logMax == format.logMax)
+        return false;
+
+    format.logMin = logMin;
+    format.logMax = logMax;
+
+    return format.IsLogarithmic();
+}
+
+void HeightmapTexture::Upload(const float* image, unsigned int first, unsigned int count)
+{
+    count = std::min(count, columns);
+    if(count == 0)
+        return;
+
+    first %= columns;
+    if(pendingCount == 0)
+    {
+        pendingFirst = first;
+        pendingCount = count;
+    }
+    else if(first == (pendingFirst + pendingCount) % columns)
+    {
+        pendingCount = std::min(pendingCount + count, columns);
+    }
+    else
+    {
+        pendingFirst = 0;
+        pendingCount = columns;
+    }
+
+    Flush(image);
+}
+
+void HeightmapTexture::Flush(const float* image)
+{
+    if(pendingCount == 0)
+        return;
+
+    if(uploader)
+    {
+        // The history always holds the newest columns, so whenever the range
+        // finally goes up it uploads the current state
+        if(uploader->Upload(texture, image, pendingFirst, pendingCount, format))
+            pendingCount = 0;
+
+        return;
+    }
+
+    // A block of columns is a block of texture rows and contiguous in the
+    // history. At most two blocks, if the range wraps around. Float texels go
+    // up straight from the history, anything else is converted first. The
+    // rows are tightly packed whatever the unpack state was left at
+    glBindTexture(GL_TEXTURE_2D, texture);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
+
+    auto upload = [this, image](unsigned int column, unsigned int length)
+    {
+        const float* source = image + (size_t)column * rows;
+        const void* texels = source;
+        if(!staging.empty())
+        {
+            format.Convert(source, (size_t)length * rows, staging.data());
+            texels = staging.data();
+        }
+
+        glTexSubImage2D(GL_TEXTURE_2D, 0, 0, column, rows, length, GL_RED, format.GetPixelType(), texels);
+    };
+
+    unsigned int head = std::min(pendingCount, columns - pendingFirst);
+    upload(pendingFirst, head);
+
+    if(pendingCount > head)
+        upload(0, pendingCount - head);
+
+    pendingCount = 0;
+}
@@ -0,0 +1,62 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "PixelUploader.hpp"
+#include "TexelFormat.hpp"
+
+// The heightmap texture of a column history and everything that keeps it up
+// to date. It is transposed like the history, every column is one texture
+// row, and repeats vertically so the rows can be addressed as a ring.
+//
+// Columns that can't go up yet because the staging ring is still busy are
+// kept as one range of the ring, which goes up with the next upload or
+// Flush(). Needs a current GL context but nothing else of the renderer.
+class HeightmapTexture
+{
+public:
+    // Allocated once and never resized. Uploads are streamed through a
+    // PixelUploader if stream is set, synchronous otherwise
+    HeightmapTexture(unsigned int columns, unsigned int rows, TextureStorage storage, bool stream = PixelUploader::IsSupported());
+    ~HeightmapTexture();
+
+    HeightmapTexture(const HeightmapTexture& other) = delete;
+    HeightmapTexture& operator=(const HeightmapTexture& other) = delete;
+
+    // Uploads count columns of the column-major image from first on, wrapping
+    // around the last one. Never waits for the driver, columns that can't go
+    // up yet are merged with the pending ones. New columns usually continue
+    // the pending range, anything else makes the whole image pending
+    void Upload(const float* image, unsigned int first, unsigned int count);
+
+    // Uploads the pending columns from image, if the staging ring lets it
+    void Flush(const float* image);
+
+    // Log2 of the smallest and the largest magnitude the logarithmic storage
+    // modes can represent. Returns whether the texels are out of date now
+    bool SetLogRange(float logMin, float logMax);
+
+    inline unsigned int GetTexture() const { return texture; }
+    inline const TexelFormat& GetFormat() const { return format; }
+
+    // Columns waiting for a free staging region
+    inline unsigned int GetPendingColumns() const { return pendingCount; }
+
+    // Uploads that had to be put off because the driver was still busy
+    inline uint64_t GetDeferredUploads() const { return uploader ? uploader->GetDeferred() : 0; }
+
+private:
+    unsigned int columns, rows;
+
+    unsigned int texture = 0;
+    TexelFormat format;
+
+    std::unique_ptr<PixelUploader> uploader;
+    unsigned int pendingFirst = 0;
+    unsigned int pendingCount = 0;
+
+    // Converted columns of the synchronous uploads
+    std::vector<uint8_t> staging;
+};
@@ -0,0 +1,186 @@
+#include "ImageWriter.hpp"
+
+#include <algorithm>
+#include <array>
+#include <fstream>
+#include <stdexcept>
+#include <vector>
+
+void WriteRawImage(const std::string& path, const float* pixels, size_t width, size_t height)
+{
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    file.write(reinterpret_cast<const char*>(pixels), (std::streamsize)(width * height * sizeof(float)));
+
+    if(!file.good())
+        throw std::runtime_error("Failed to write \"" + path + "\"");
+}
+
+static uint32_t UpdateCrc(uint32_t crc, const uint8_t* data, size_t size)
+{
+    static const std::array<uint32_t, 256> table = []()
+    {
+        std::array<uint32_t, 256> table;
+        for(uint32_t n = 0; n < 256; n++)
+        {
+            uint32_t c = n;
+            for(int k = 0; k < 8; k++)
+                c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : (c >> 1);
+
+            table[n] = c;
+        }
+
+        return table;
+    }();
+
+    crc = ~crc;
+    for(size_t i = 0; i < size; i++)
+        crc = table[(crc ^ data[i]) & 0xFF] ^ (crc >> 8);
+
+    return ~crc;
+}
+
+// Adler-32 of the zlib stream. The sums are only reduced every 5552 bytes,
+// the most that can be added up before they overflow 32 bits
+static void UpdateAdler(uint32_t& a, uint32_t& b, const uint8_t* data, size_t size)
+{
+    while(size > 0)
+    {
+        size_t count = std::min<size_t>(size, 5552);
+        for(size_t i = 0; i < count; i++)
+        {
+            a += data[i];
+            b += a;
+        }
+
+        a %= 65521;
+        b %= 65521;
+        data += count;
+        size -= count;
+    }
+}
+
+// Big endian PNG chunk writer that keeps the running CRC of the current chunk
+class PngChunkWriter
+{
+public:
+    PngChunkWriter(std::ofstream& file) : file(file) {}
+
+    void Begin(const char* type, uint32_t length)
+    {
+        uint8_t header[8] = {
+            (uint8_t)(length >> 24), (uint8_t)(length >> 16), (uint8_t)(length >> 8), (uint8_t)length,
+            (uint8_t)type[0], (uint8_t)type[1], (uint8_t)type[2], (uint8_t)type[3]
+        };
+
+        file.write(reinterpret_cast<const char*>(header), 8);
+        crc = UpdateCrc(0, header + 4, 4);
+    }
+
+    void Write(const uint8_t* data, size_t size)
+    {
+        file.write(reinterpret_cast<const char*>(data), (std::streamsize)size);
+        crc = UpdateCrc(crc, data, size);
+    }
+
+    void Write32(uint32_t value)
+    {
+        uint8_t bytes[4] = { (uint8_t)(value >> 24), (uint8_t)(value >> 16), (uint8_t)(value >> 8), (uint8_t)value };
+        Write(bytes, 4);
+    }
+
+    void End()
+    {
+        uint32_t value = crc;
+        uint8_t bytes[4] = { (uint8_t)(value >> 24), (uint8_t)(value >> 16), (uint8_t)(value >> 8), (uint8_t)value };
+        file.write(reinterpret_cast<const char*>(bytes), 4);
+    }
+
+private:
+    std::ofstream& file;
+    uint32_t crc = 0;
+};
+
+void WritePng16(const std::string& path, const uint16_t* pixels, size_t width, size_t height)
+{
+    // Every row starts with its filter type, 0 for none
+    const size_t MAX_BLOCK = 65535;
+    uint64_t rowBytes = 1 + 2 * (uint64_t)width;
+    uint64_t rawBytes = rowBytes * height;
+    uint64_t blocks = std::max<uint64_t>((rawBytes + MAX_BLOCK - 1) / MAX_BLOCK, 1);
+
+    // zlib header, 5 bytes per stored block and the Adler-32 at the end
+    uint64_t idatBytes = 2 + rawBytes + 5 * blocks + 4;
+    if(width == 0 || height == 0 || width > 0x7FFFFFFF || height > 0x7FFFFFFF || idatBytes > 0x7FFFFFFF)
+        throw std::runtime_error("Image of " + std::to_string(width) + "x" + std::to_string(height) + " can't be stored as PNG");
+
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    PngChunkWriter png(file);
+
+    static const uint8_t signature[8] = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n' };
+    file.write(reinterpret_cast<const char*>(signature), 8);
+
+    // 16 bit grayscale, no interlacing
+    png.Begin("IHDR", 13);
+    png.Write32((uint32_t)width);
+    png.Write32((uint32_t)height);
+    const uint8_t format[5] = { 16, 0, 0, 0, 0 };
+    png.Write(format, 5);
+    png.End();
+
+    png.Begin("IDAT", (uint32_t)idatBytes);
+    const uint8_t zlibHeader[2] = { 0x78, 0x01 };
+    png.Write(zlibHeader, 2);
+
+    uint32_t adlerA = 1, adlerB = 0;
+    uint64_t remaining = rawBytes;
+    size_t blockLeft = 0;
+
+    // Rows are serialized one at a time and cut into stored blocks as they go
+    std::vector<uint8_t> row(rowBytes);
+    for(size_t y = 0; y < height; y++)
+    {
+        row[0] = 0;
+        const uint16_t* source = pixels + y * width;
+        for(size_t x = 0; x < width; x++)
+        {
+            row[1 + 2 * x] = (uint8_t)(source[x] >> 8);
+            row[2 + 2 * x] = (uint8_t)(source[x] & 0xFF);
+        }
+
+        UpdateAdler(adlerA, adlerB, row.data(), row.size());
+
+        const uint8_t* data = row.data();
+        size_t size = row.size();
+        while(size > 0)
+        {
+            if(blockLeft == 0)
+            {
+                blockLeft = (size_t)std::min<uint64_t>(remaining, MAX_BLOCK);
+                uint8_t final = (remaining == blockLeft) ? 1 : 0;
+                uint8_t header[5] = {
+                    final,
+                    (uint8_t)(blockLeft & 0xFF), (uint8_t)(blockLeft >> 8),
+                    (uint8_t)(~blockLeft & 0xFF), (uint8_t)((~blockLeft >> 8) & 0xFF)
+                };
+                png.Write(header, 5);
+            }
+
+            size_t count = std::min(size, blockLeft);
+            png.Write(data, count);
+
+            data += count;
+            size -= count;
+            blockLeft -= count;
+            remaining -= count;
+        }
+    }
+
+    png.Write32((adlerB << 16) | adlerA);
+    png.End();
+
+    png.Begin("IEND", 0);
+    png.End();
+
+    if(!file.good())
+        throw std::runtime_error("Failed to write \"" + path + "\"");
+}
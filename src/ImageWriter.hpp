@@ -0,0 +1,14 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// Writes width * height floats row by row in host byte order, without any
+// header. Throws std::runtime_error if the file can't be written
+void WriteRawImage(const std::string& path, const float* pixels, size_t width, size_t height);
+
+// Writes a 16 bit grayscale PNG, the first row of pixels is the top of the
+// image. The pixel data is stored uncompressed (deflate stored blocks), so no
+// zlib is needed. Throws std::runtime_error if the file can't be written
+void WritePng16(const std::string& path, const uint16_t* pixels, size_t width, size_t height);
@@ -0,0 +1,99 @@
+#include "MappedFile.hpp"
+
+#include <stdexcept>
+
+#ifdef _WIN32
+    #define WIN32_LEAN_AND_MEAN
+    #include <Windows.h>
+#else
+    #include <fcntl.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <unistd.h>
+#endif
+
+#ifdef _WIN32
+
+MappedFile::MappedFile(const std::string& path)
+{
+    file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+    if(file == INVALID_HANDLE_VALUE)
+        throw std::runtime_error("Failed to open \"" + path + "\"");
+
+    LARGE_INTEGER fileSize;
+    GetFileSizeEx(file, &fileSize);
+    size = (uint64_t)fileSize.QuadPart;
+
+    // Empty files can't be mapped, but are valid files nonetheless
+    if(size == 0)
+        return;
+
+    mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+    if(mapping == NULL)
+    {
+        CloseHandle(file);
+        throw std::runtime_error("Failed to map \"" + path + "\"");
+    }
+
+    data = (const uint8_t*)MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    if(data == nullptr)
+    {
+        CloseHandle(mapping);
+        CloseHandle(file);
+        throw std::runtime_error("Failed to map \"" + path + "\"");
+    }
+}
+
+MappedFile::~MappedFile()
+{
+    if(data != nullptr)
+        UnmapViewOfFile(data);
+
+    if(mapping != nullptr)
+        CloseHandle(mapping);
+
+    CloseHandle(file);
+}
+
+#else
+
+MappedFile::MappedFile(const std::string& path)
+{
+    int fd = open(path.c_str(), O_RDONLY);
+    if(fd < 0)
+        throw std::runtime_error("Failed to open \"" + path + "\"");
+
+    struct stat info;
+    if(fstat(fd, &info) != 0)
+    {
+        close(fd);
+        throw std::runtime_error("Failed to stat \"" + path + "\"");
+    }
+
+    // Empty files can't be mapped, but are valid files nonetheless
+    size = (uint64_t)info.st_size;
+    if(size > 0)
+    {
+        void* address = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if(address == MAP_FAILED)
+        {
+            close(fd);
+            throw std::runtime_error("Failed to map \"" + path + "\"");
+        }
+
+        // Audio is mostly read front to back
+        madvise(address, size, MADV_SEQUENTIAL);
+        data = (const uint8_t*)address;
+    }
+
+    // The mapping stays valid after the descriptor is closed
+    close(fd);
+}
+
+MappedFile::~MappedFile()
+{
+    if(data != nullptr)
+        munmap((void*)data, size);
+}
+
+#endif
\ No newline at end of file
@@ -0,0 +1,28 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+// Read-only memory mapping of a whole file. The pages are loaded lazily by
+// the OS, so mapping a large file costs neither time nor memory up front.
+class MappedFile
+{
+public:
+    MappedFile(const std::string& path);
+    ~MappedFile();
+
+    MappedFile(const MappedFile& other) = delete;
+    MappedFile& operator=(const MappedFile& other) = delete;
+
+    inline const uint8_t* GetData() const { return data; }
+    inline uint64_t GetSize() const { return size; }
+
+private:
+    const uint8_t* data = nullptr;
+    uint64_t size = 0;
+
+#ifdef _WIN32
+    void* file = nullptr;
+    void* mapping = nullptr;
+#endif
+};
\ No newline at end of file
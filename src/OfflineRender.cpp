@@ -0,0 +1,93 @@
+#include "OfflineRender.hpp"
+
+#include <algorithm>
+#include <cctype>
+#include <iostream>
+#include <stdexcept>
+#include <vector>
+
+#include "AudioFile.hpp"
+#include "OfflineSpectrogram.hpp"
+#include "ImageWriter.hpp"
+#include "ValueRange.hpp"
+
+static bool EndsWith(const std::string& text, const std::string& suffix)
+{
+    if(text.size() < suffix.size())
+        return false;
+
+    return std::equal(suffix.rbegin(), suffix.rend(), text.rbegin(),
+        [](char a, char b) { return std::tolower((unsigned char)a) == b; }
+    );
+}
+
+void RenderOffline(const std::string& input, const std::string& output, const OfflineRenderSettings& settings)
+{
+    AudioFile audio(input);
+    if(audio.GetFrameCount() == 0)
+        throw std::runtime_error("\"" + input + "\" contains no audio");
+
+    SpectrogramSettings analysis = settings.spectrogram;
+    float sampleRate = (float)audio.GetAudioSpec().freq;
+    size_t channels = std::max(audio.GetChannels(), 1u);
+    std::vector<ChannelMix> mixes = MakeChannelMixes(analysis.channelView, channels);
+
+    // Same setup as a precomputed Spectrogram
+    float maxFrequency = (analysis.maxFrequency > 0.0f) ? analysis.maxFrequency : sampleRate / 2.0f;
+    if(analysis.decimate)
+        analysis.stft.decimation = ChooseDecimation(analysis.stft, sampleRate, maxFrequency);
+
+    Stft stft(analysis.stft);
+    float analysisRate = sampleRate / (float)analysis.stft.decimation;
+    BinningKernel binning(analysis.scale, stft.GetTransformSize(), analysisRate, settings.rows / mixes.size(), analysis.minFrequency, maxFrequency);
+
+    audio.Normalize();
+    binning.Scale(audio.GetGain());
+
+    ThreadPool pool(std::max<size_t>(settings.threads, 1));
+    OfflineSpectrogram spectrogram(
+        [&audio](uint64_t first, size_t count, float* buffer) { return audio.GetFrames(first, count, buffer); },
+        audio.GetFrameCount(),
+        mixes, analysis.stft, binning, pool
+    );
+
+    size_t width = spectrogram.GetColumns();
+    size_t height = spectrogram.GetRows();
+    if(width == 0)
+        throw std::runtime_error("\"" + input + "\" is shorter than one hop");
+
+    // The columns are stored one after another, image files are stored row
+    // by row
+    std::vector<float> image(width * height);
+    for(size_t x = 0; x < width; x++)
+    {
+        const float* column = spectrogram.GetColumn(x);
+        for(size_t y = 0; y < height; y++)
+            image[y * width + x] = column[y];
+    }
+
+    if(EndsWith(output, ".png"))
+    {
+        // Flipped, so the low frequencies end up at the bottom
+        ValueRange range = FindRange(image.data(), image.size());
+        float scale = (range.maximum > range.minimum) ? 65535.0f / (range.maximum - range.minimum) : 0.0f;
+
+        std::vector<uint16_t> pixels(image.size());
+        for(size_t y = 0; y < height; y++)
+        {
+            const float* source = image.data() + (height - 1 - y) * width;
+            uint16_t* target = pixels.data() + y * width;
+
+            for(size_t x = 0; x < width; x++)
+                target[x] = (uint16_t)std::clamp((source[x] - range.minimum) * scale + 0.5f, 0.0f, 65535.0f);
+        }
+
+        WritePng16(output, pixels.data(), width, height);
+    }
+    else
+    {
+        WriteRawImage(output, image.data(), width, height);
+    }
+
+    std::cout << "Wrote " << width << "x" << height << " spectrogram of \"" << input << "\" to \"" << output << "\"" << std::endl;
+}
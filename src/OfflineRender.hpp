@@ -0,0 +1,25 @@
+#pragma once
+
+#include <string>
+#include <thread>
+
+#include "SpectrogramSettings.hpp"
+
+struct OfflineRenderSettings
+{
+    // Always analyzed with the FFT, the mode is ignored
+    SpectrogramSettings spectrogram;
+    unsigned int rows = 2000;
+    size_t threads = std::thread::hardware_concurrency();
+};
+
+// Computes every column of a file and writes them as one image, without any
+// window or GL context. The columns are spread across a thread pool like a
+// precomputed Spectrogram's, with the same analysis, so the image matches
+// what the application shows. Each column becomes one image column, with
+// the lowest frequency in the first row of raw output and at the bottom of
+// a PNG.
+//
+// Output ending in .png is a 16 bit grayscale PNG spanning the image's
+// range, anything else raw float32 magnitudes. Throws std::runtime_error
+void RenderOffline(const std::string& input, const std::string& output, const OfflineRenderSettings& settings = OfflineRenderSettings());
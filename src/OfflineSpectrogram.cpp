@@ -0,0 +1,81 @@
+#include "OfflineSpectrogram.hpp"
+
+#include <algorithm>
+#include <memory>
+
+OfflineSpectrogram::OfflineSpectrogram(
+    const FrameReader& read, uint64_t count,
+    const std::vector<ChannelMix>& mixes,
+    const StftSettings& settings,
+    const BinningKernel& binning,
+    ThreadPool& pool
+) :
+    rows(mixes.size() * binning.GetRows())
+{
+    columns = (size_t)(count / settings.hopSize);
+    data.resize(columns * rows);
+
+    struct Worker
+    {
+        std::vector<std::unique_ptr<Stft>> stfts;
+        std::vector<float> frames;
+        std::vector<float> magnitudes;
+    };
+
+    std::vector<Worker> workers(pool.GetThreadCount());
+    size_t channels = mixes.front().channels;
+    size_t bandRows = binning.GetRows();
+    size_t hop = settings.hopSize;
+
+    // Jobs are blocks of consecutive columns. Their frames overlap, so a block
+    // reads all of them once and every mix of every column is analyzed from
+    // that one read
+    const size_t block = 64;
+    pool.ParallelFor(columns, block,
+        [&](size_t worker, size_t begin, size_t end)
+        {
+            Worker& state = workers[worker];
+            if(state.stfts.empty())
+            {
+                for(const ChannelMix& mix : mixes)
+                    state.stfts.push_back(std::make_unique<Stft>(settings, mix));
+
+                state.frames.resize(((block - 1) * hop + state.stfts[0]->GetInputSpan()) * channels);
+                state.magnitudes.resize(state.stfts[0]->GetBins());
+            }
+
+            size_t span = state.stfts[0]->GetInputSpan();
+
+            // A column's frame ends after its hop. Frames reaching before the
+            // first sample see zeros just like the stream does
+            uint64_t frameEnd = (uint64_t)(begin + 1) * hop;
+            size_t length = (end - begin - 1) * hop + span;
+            const float* frames = state.frames.data();
+            if(frameEnd >= span)
+            {
+                frames = read(frameEnd - span, length, state.frames.data());
+            }
+            else
+            {
+                size_t missing = (size_t)(span - frameEnd);
+                float* rest = state.frames.data() + missing * channels;
+                std::fill(state.frames.data(), rest, 0.0f);
+
+                // Views can't be zero padded, they are copied behind the zeros
+                const float* first = read(0, length - missing, rest);
+                if(first != rest)
+                    std::copy(first, first + (length - missing) * channels, rest);
+            }
+
+            for(size_t column = begin; column < end; column++)
+            {
+                const float* frame = frames + (column - begin) * hop * channels;
+                for(size_t band = 0; band < mixes.size(); band++)
+                {
+                    state.stfts[band]->AnalyzeFrame(frame, state.magnitudes.data());
+                    binning.Apply(state.magnitudes.data(), data.data() + column * rows + band * bandRows);
+                }
+            }
+        }
+    );
+}
\ No newline at end of file
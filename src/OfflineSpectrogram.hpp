@@ -0,0 +1,47 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+#include "Stft.hpp"
+#include "BinningKernel.hpp"
+#include "ThreadPool.hpp"
+
+// Every column of a signal that is fully in memory, computed up front. The
+// work is spread across a thread pool in blocks of consecutive columns, each
+// worker has its own FFT plans and scratch buffers. Column c is identical to
+// what a streaming Stft yields after (c + 1) * hopSize frames.
+//
+// The signal is pulled through a reader, so only the frames of the blocks
+// currently analyzed ever exist as floats, and float samples in memory are
+// analyzed where they are. Each block reads its frames once, however many
+// channel mixes are analyzed from them.
+//
+// Every channel mix gets its own band of binning.GetRows() rows, stacked in
+// the order of the mixes.
+class OfflineSpectrogram
+{
+public:
+    // Returns count interleaved frames starting at first, either where they
+    // already are or written to buffer. Called from the worker threads, so it
+    // must be safe to call concurrently
+    using FrameReader = std::function<const float*(uint64_t first, size_t count, float* buffer)>;
+
+    OfflineSpectrogram(
+        const FrameReader& read, uint64_t count,
+        const std::vector<ChannelMix>& mixes,
+        const StftSettings& settings,
+        const BinningKernel& binning,
+        ThreadPool& pool
+    );
+
+    inline const float* GetColumn(size_t column) const { return data.data() + column * rows; }
+    inline size_t GetColumns() const { return columns; }
+    inline size_t GetRows() const { return rows; }
+
+private:
+    size_t columns;
+    size_t rows;
+    std::vector<float> data;
+};
\ No newline at end of file
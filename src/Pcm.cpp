@@ -0,0 +1,28 @@
+#include "Pcm.hpp"
+
+#include <stdexcept>
+
+#include "Simd.hpp"
+
+size_t GetBytesPerSample(SampleFormat format)
+{
+    switch(format)
+    {
+    case SampleFormat::U8:      return 1;
+    case SampleFormat::S16:     return 2;
+    case SampleFormat::S24:     return 3;
+    case SampleFormat::S32:     return 4;
+    case SampleFormat::F32:     return 4;
+    }
+
+    return 0;
+}
+
+void ConvertPcm(const PcmView& view, uint64_t firstFrame, size_t count, float* output, bool downmix)
+{
+    if(downmix && view.channels != 2)
+        throw std::runtime_error("Only stereo PCM can be downmixed");
+
+    const uint8_t* input = view.data + firstFrame * view.GetFrameSize();
+    GetSimdKernels().ConvertPcm(input, count * view.channels, view.format, view.bigEndian, downmix, output);
+}
\ No newline at end of file
@@ -0,0 +1,36 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+enum class SampleFormat
+{
+    U8,
+    S16,
+    S24,        // Packed, three bytes per sample
+    S32,
+    F32
+};
+
+size_t GetBytesPerSample(SampleFormat format);
+
+// Zero-copy view of interleaved PCM samples, e.g. straight into a mapped file
+struct PcmView
+{
+    const uint8_t* data = nullptr;
+    SampleFormat format = SampleFormat::F32;
+    bool bigEndian = false;
+    unsigned int channels = 1;
+    uint64_t frames = 0;
+
+    inline size_t GetFrameSize() const { return GetBytesPerSample(format) * channels; }
+
+    // The samples as their storage type. Only meaningful for host endianness
+    // and formats with a native type, and the data may be unaligned
+    template<typename T>
+    inline const T* As() const { return reinterpret_cast<const T*>(data); }
+};
+
+// Converts count frames from firstFrame on to interleaved floats in [-1, 1).
+// With downmix, every stereo frame is averaged into a single mono value
+void ConvertPcm(const PcmView& view, uint64_t firstFrame, size_t count, float* output, bool downmix = false);
\ No newline at end of file
@@ -0,0 +1,102 @@
+#include "PixelUploader.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+#include <glad/glad.h>
+
+PixelUploader::PixelUploader(unsigned int columns, unsigned int rows, size_t texelSize) :
+    columns(columns), rows(rows), texelSize(texelSize), regionSize((size_t)columns * rows * texelSize)
+{
+    // Coherent, so the copies are visible to the driver without flushing
+    GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+
+    glGenBuffers(1, &buffer);
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, buffer);
+    glBufferStorage(GL_PIXEL_UNPACK_BUFFER, REGIONS * regionSize, nullptr, flags);
+    mapped = (uint8_t*)glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, REGIONS * regionSize, flags);
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+
+    if(mapped == nullptr)
+    {
+        glDeleteBuffers(1, &buffer);
+        throw std::runtime_error("Failed to map the pixel upload buffer");
+    }
+}
+
+PixelUploader::~PixelUploader()
+{
+    for(GLsync fence : fences)
+    {
+        if(fence != nullptr)
+            glDeleteSync(fence);
+    }
+
+    // Deleting the buffer also unmaps it
+    glDeleteBuffers(1, &buffer);
+}
+
+bool PixelUploader::IsSupported()
+{
+    return GLAD_GL_VERSION_4_4;
+}
+
+bool PixelUploader::Upload(unsigned int texture, const float* image, unsigned int first, unsigned int count, const TexelFormat& format)
+{
+    count = std::min(count, columns);
+    if(count == 0)
+        return true;
+
+    // Polled, never waited on. A timeout of 0 only flushes the fence
+    GLsync& fence = fences[next];
+    if(fence != nullptr)
+    {
+        GLenum status = glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, 0);
+        if(status == GL_TIMEOUT_EXPIRED)
+        {
+            deferred++;
+            return false;
+        }
+
+        glDeleteSync(fence);
+        fence = nullptr;
+    }
+
+    size_t regionOffset = next * regionSize;
+    uint8_t* region = mapped + regionOffset;
+
+    // 8 bit rows of odd length aren't aligned to anything, and the blocks
+    // are tightly packed whatever row length was left set
+    glBindTexture(GL_TEXTURE_2D, texture);
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, buffer);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
+
+    // Columns are contiguous already, a range that wraps around ends up as
+    // two blocks back to back in the region
+    first %= columns;
+    unsigned int head = std::min(count, columns - first);
+    unsigned int blocks[2][2] = { { first, head }, { 0, count - head } };
+
+    size_t packed = 0;
+    for(const auto& block : blocks)
+    {
+        unsigned int column = block[0], length = block[1];
+        if(length == 0)
+            continue;
+
+        size_t values = (size_t)length * rows;
+        format.Convert(image + (size_t)column * rows, values, region + packed);
+
+        const void* source = reinterpret_cast<const void*>(regionOffset + packed);
+        glTexSubImage2D(GL_TEXTURE_2D, 0, 0, column, rows, length, GL_RED, format.GetPixelType(), source);
+
+        packed += values * texelSize;
+    }
+
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+
+    fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    next = (next + 1) % REGIONS;
+
+    return true;
+}
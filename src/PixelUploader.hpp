@@ -0,0 +1,52 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include "TexelFormat.hpp"
+
+// Same as glad's, so the header doesn't need to pull in all of GL
+typedef struct __GLsync* GLsync;
+
+// Streams column updates of a transposed texture, whose rows are the columns
+// of the image, through a ring of persistently mapped pixel buffers. The
+// columns are converted into a free region of staging memory in the texture's
+// format and the texture update is sourced from there, so the driver
+// transfers them whenever it likes. A fence after every upload tells when a
+// region may be written again. Upload() never waits for one, if the next
+// region is still being read it declines and the caller tries again later.
+class PixelUploader
+{
+public:
+    static constexpr size_t REGIONS = 3;
+
+    // Every region holds a whole image of columns * rows texels of texelSize bytes
+    PixelUploader(unsigned int columns, unsigned int rows, size_t texelSize);
+    ~PixelUploader();
+
+    PixelUploader(const PixelUploader& other) = delete;
+    PixelUploader& operator=(const PixelUploader& other) = delete;
+
+    // Whether the context can map buffers persistently (GL 4.4)
+    static bool IsSupported();
+
+    // Uploads count columns of the column-major image from first on, wrapping
+    // around the last one, into texture, converted to format. Returns false
+    // without touching anything if the next region is still in flight
+    bool Upload(unsigned int texture, const float* image, unsigned int first, unsigned int count, const TexelFormat& format);
+
+    // Uploads that were declined because every region was busy
+    inline uint64_t GetDeferred() const { return deferred; }
+
+private:
+    unsigned int columns, rows;
+    size_t texelSize;
+    size_t regionSize;
+
+    unsigned int buffer = 0;
+    uint8_t* mapped = nullptr;
+
+    GLsync fences[REGIONS] = {};
+    size_t next = 0;
+    uint64_t deferred = 0;
+};
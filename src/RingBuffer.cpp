@@ -0,0 +1,57 @@
+#include "RingBuffer.hpp"
+
+#include <algorithm>
+
+RingBuffer::RingBuffer(size_t capacity) :
+    writePos(0), readPos(0)
+{
+    size_t size = 1;
+    while(size < capacity)
+        size <<= 1;
+
+    buffer.resize(size, 0.0f);
+    mask = size - 1;
+}
+
+size_t RingBuffer::Write(const float* values, size_t count)
+{
+    size_t write = writePos.load(std::memory_order_relaxed);
+    size_t read = readPos.load(std::memory_order_acquire);
+
+    count = std::min(count, buffer.size() - (write - read));
+
+    // The free space wraps around at most once
+    size_t start = write & mask;
+    size_t first = std::min(count, buffer.size() - start);
+    std::copy(values, values + first, buffer.begin() + start);
+    std::copy(values + first, values + count, buffer.begin());
+
+    writePos.store(write + count, std::memory_order_release);
+    return count;
+}
+
+size_t RingBuffer::Read(float* values, size_t count)
+{
+    size_t read = readPos.load(std::memory_order_relaxed);
+    size_t write = writePos.load(std::memory_order_acquire);
+
+    count = std::min(count, write - read);
+
+    size_t start = read & mask;
+    size_t first = std::min(count, buffer.size() - start);
+    std::copy(buffer.begin() + start, buffer.begin() + start + first, values);
+    std::copy(buffer.begin(), buffer.begin() + (count - first), values + first);
+
+    readPos.store(read + count, std::memory_order_release);
+    return count;
+}
+
+size_t RingBuffer::GetReadable() const
+{
+    return writePos.load(std::memory_order_acquire) - readPos.load(std::memory_order_acquire);
+}
+
+size_t RingBuffer::GetWritable() const
+{
+    return buffer.size() - GetReadable();
+}
\ No newline at end of file
@@ -0,0 +1,39 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <vector>
+
+// Lock-free ring of floats for exactly one producer and one consumer thread,
+// e.g. an audio callback feeding the analysis. Neither side ever blocks or
+// allocates, the capacity is fixed on construction.
+class RingBuffer
+{
+public:
+    // Rounds the capacity up to a power of two
+    RingBuffer(size_t capacity);
+
+    RingBuffer(const RingBuffer& other) = delete;
+    RingBuffer& operator=(const RingBuffer& other) = delete;
+
+    // Producer side. Writes as many values as fit, returns how many that were
+    size_t Write(const float* values, size_t count);
+
+    // Consumer side. Reads up to count values, returns how many were read
+    size_t Read(float* values, size_t count);
+
+    // Exact for the calling side, conservative for the other one
+    size_t GetReadable() const;
+    size_t GetWritable() const;
+
+    inline size_t GetCapacity() const { return buffer.size(); }
+
+private:
+    std::vector<float> buffer;
+    size_t mask;
+
+    // Free running counters on their own cache lines, so the two threads
+    // don't invalidate each other's line on every update
+    alignas(64) std::atomic<size_t> writePos;
+    alignas(64) std::atomic<size_t> readPos;
+};
\ No newline at end of file
@@ -0,0 +1,23 @@
+#include "SampleStore.hpp"
+
+#include <algorithm>
+
+SampleStore::SampleStore(std::vector<float>&& samples, unsigned int channels, unsigned int sampleRate) :
+    samples(std::move(samples)), channels(std::max(channels, 1u)), sampleRate(sampleRate)
+{
+    // A trailing partial frame is never visible through the views
+    frames = this->samples.size() / this->channels;
+}
+
+std::shared_ptr<const SampleStore> SampleStore::Create(std::vector<float> samples, unsigned int channels, unsigned int sampleRate)
+{
+    return std::shared_ptr<const SampleStore>(new SampleStore(std::move(samples), channels, sampleRate));
+}
+
+FrameView SampleStore::GetFrames(uint64_t first, size_t count) const
+{
+    if(first >= frames)
+        return FrameView{ nullptr, channels, 0 };
+
+    return GetFrames().Slice((size_t)first, (size_t)std::min<uint64_t>(count, frames - first));
+}
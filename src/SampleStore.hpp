@@ -0,0 +1,50 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+// Non-owning view of interleaved float frames. Cheap to copy, slicing and
+// extracting frames is just pointer arithmetic. Valid as long as whatever
+// holds the samples is alive.
+struct FrameView
+{
+    const float* data = nullptr;
+    unsigned int channels = 1;
+    size_t frames = 0;
+
+    inline const float* GetFrame(size_t frame) const { return data + frame * channels; }
+    inline FrameView Slice(size_t first, size_t count) const { return FrameView{ GetFrame(first), channels, count }; }
+
+    inline size_t GetSamples() const { return frames * channels; }
+    inline bool IsEmpty() const { return frames == 0; }
+};
+
+// Decoded signal that never changes once created. It is only handed out
+// through shared pointers, so any number of analyzers, views and AudioFile
+// copies can read from it concurrently without copying or locking.
+class SampleStore
+{
+public:
+    // Takes over samples, which hold whole interleaved frames
+    static std::shared_ptr<const SampleStore> Create(std::vector<float> samples, unsigned int channels, unsigned int sampleRate);
+
+    inline FrameView GetFrames() const { return FrameView{ samples.data(), channels, frames }; }
+
+    // Up to count frames from first on, fewer at the end of the signal
+    FrameView GetFrames(uint64_t first, size_t count) const;
+
+    inline uint64_t GetFrameCount() const { return frames; }
+    inline unsigned int GetChannels() const { return channels; }
+    inline unsigned int GetSampleRate() const { return sampleRate; }
+
+private:
+    SampleStore(std::vector<float>&& samples, unsigned int channels, unsigned int sampleRate);
+
+private:
+    std::vector<float> samples;
+    unsigned int channels;
+    unsigned int sampleRate;
+    size_t frames;
+};
@@ -23,25 +23,26 @@ ScrollingPlot::ScrollingPlot(
 
 void ScrollingPlot::StepForward(unsigned int steps)
 {
+    unsigned int first = currentStrip;
     for(unsigned int n = 0; n < steps; n++)
     {
         t += dt;
         CalculateStrip(currentStrip);
-        currentStrip = (currentStrip + 1) % image.GetDimensions().x;
+        currentStrip = (currentStrip + 1) % GetSize().x;
 
-        offset += 1.0f / (float)image.GetDimensions().x;
+        offset += 1.0f / (float)GetSize().x;
     }
-    MakeTexture();
+    UploadColumns(first, steps);
 }
 
 void ScrollingPlot::CalculateStrip(unsigned int strip)
 {
-    float* pixels = GetTopology();
-    glm::uvec2 size = image.GetDimensions();
+    float* column = GetColumn(strip);
+    glm::uvec2 size = GetSize();
 
     for(unsigned int y = 0; y < size.y; y++)
     {
-        pixels[y * size.x + strip] = func(
+        column[y] = func(
             t,
             Map(glm::vec2(0.0f, size.y), domain, y)
         );
@@ -0,0 +1,103 @@
+#include "Simd.hpp"
+
+#ifdef VISUALIZER_X86_KERNELS
+    #ifdef _MSC_VER
+        #include <intrin.h>
+    #else
+        #include <cpuid.h>
+    #endif
+#endif
+
+#ifdef VISUALIZER_X86_KERNELS
+static void Cpuid(unsigned int leaf, unsigned int subleaf, unsigned int regs[4])
+{
+#ifdef _MSC_VER
+    int info[4];
+    __cpuidex(info, leaf, subleaf);
+    for(int i = 0; i < 4; i++)
+        regs[i] = info[i];
+#else
+    __cpuid_count(leaf, subleaf, regs[0], regs[1], regs[2], regs[3]);
+#endif
+}
+
+static unsigned long long Xgetbv()
+{
+#ifdef _MSC_VER
+    return _xgetbv(0);
+#else
+    unsigned int eax, edx;
+    __asm__ volatile("xgetbv" : "=a"(eax), "=d"(edx) : "c"(0));
+    return ((unsigned long long)edx << 32) | eax;
+#endif
+}
+#endif
+
+SimdLevel DetectSimdLevel()
+{
+#ifdef VISUALIZER_X86_KERNELS
+    unsigned int regs[4];
+    Cpuid(0, 0, regs);
+    unsigned int maxLeaf = regs[0];
+
+    Cpuid(1, 0, regs);
+    bool sse2 = regs[3] & (1u << 26);
+    bool fma = regs[2] & (1u << 12);
+    bool osxsave = regs[2] & (1u << 27);
+    bool avx = regs[2] & (1u << 28);
+
+    if(!sse2)
+        return SimdLevel::Scalar;
+
+    // The OS has to save the YMM (and ZMM) registers on context switches
+    unsigned long long xcr0 = osxsave ? Xgetbv() : 0;
+    if(!avx || !fma || (xcr0 & 0x6) != 0x6 || maxLeaf < 7)
+        return SimdLevel::SSE2;
+
+    Cpuid(7, 0, regs);
+    bool avx2 = regs[1] & (1u << 5);
+    bool avx512f = regs[1] & (1u << 16);
+
+    if(!avx2)
+        return SimdLevel::SSE2;
+
+    if(!avx512f || (xcr0 & 0xE6) != 0xE6)
+        return SimdLevel::AVX2;
+
+    return SimdLevel::AVX512;
+#else
+    return SimdLevel::Scalar;
+#endif
+}
+
+const SimdKernels& GetSimdKernels()
+{
+#if defined(VISUALIZER_FORCE_SIMD_SCALAR)
+    static const SimdKernels& kernels = GetSimdKernels(SimdLevel::Scalar);
+#elif defined(VISUALIZER_FORCE_SIMD_SSE2)
+    static const SimdKernels& kernels = GetSimdKernels(SimdLevel::SSE2);
+#elif defined(VISUALIZER_FORCE_SIMD_AVX2)
+    static const SimdKernels& kernels = GetSimdKernels(SimdLevel::AVX2);
+#elif defined(VISUALIZER_FORCE_SIMD_AVX512)
+    static const SimdKernels& kernels = GetSimdKernels(SimdLevel::AVX512);
+#else
+    static const SimdKernels& kernels = GetSimdKernels(DetectSimdLevel());
+#endif
+
+    return kernels;
+}
+
+const SimdKernels& GetSimdKernels(SimdLevel level)
+{
+#ifdef VISUALIZER_X86_KERNELS
+    switch(level)
+    {
+    case SimdLevel::AVX512:     return avx512Kernels;
+    case SimdLevel::AVX2:       return avx2Kernels;
+    case SimdLevel::SSE2:       return sse2Kernels;
+    default:                    break;
+    }
+#endif
+
+    return scalarKernels;
+}
\ No newline at end of file
@@ -0,0 +1,71 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include "Pcm.hpp"
+
+enum class SimdLevel
+{
+    Scalar,
+    SSE2,
+    AVX2,
+    AVX512
+};
+
+// One row of a sparse matrix whose non-zeros are contiguous. The row reads
+// length inputs from start on and their weights from offset on
+struct SparseSpan
+{
+    uint32_t start;
+    uint32_t length;
+    uint32_t offset;
+};
+
+// Function table of the DSP kernels for one instruction set. Complex data is
+// passed as interleaved (real, imaginary) pairs of floats
+struct SimdKernels
+{
+    SimdLevel level;
+    const char* name;
+
+    // One radix-2 stage over N points. Every butterfly combines two points that
+    // are half apart and applies one of the stage's half twiddle factors
+    void (*Butterflies)(float* data, size_t N, size_t half, const float* twiddles);
+
+    // output[row] = sum of weights[offset + i] * input[start + i] for every row
+    void (*SparseMultiply)(const SparseSpan* spans, size_t rows, const float* weights, const float* input, float* output);
+
+    // Converts samples packed PCM samples to floats in [-1, 1). With downmix the
+    // samples are stereo pairs, each pair is averaged into one output value.
+    // Every level produces bit-identical results to the scalar kernel
+    void (*ConvertPcm)(const uint8_t* input, size_t samples, SampleFormat format, bool bigEndian, bool downmix, float* output);
+
+    // Largest absolute value and sum of squares of count samples in one pass.
+    // The peak is exact, the sum's rounding depends on the level
+    void (*Statistics)(const float* input, size_t count, float* peak, float* sumSquares);
+
+    // Converts to IEEE half precision, rounding to nearest even. Overflow
+    // becomes infinity, NaN a quiet NaN. Bit-identical on every level
+    void (*FloatToHalf)(const float* input, size_t count, uint16_t* output);
+
+    // Quantizes logarithmic magnitudes: (log2(input) - logMin) * scale,
+    // rounded and clamped to an unsigned integer of bits (8 or 16) bits.
+    // Inputs below 2^logMin, zero and NaN become 0. The logarithm is a
+    // polynomial, levels may round to a neighbouring code
+    void (*QuantizeLog)(const float* input, size_t count, float logMin, float scale, unsigned int bits, void* output);
+};
+
+// Highest level supported by both the CPU and this build
+SimdLevel DetectSimdLevel();
+
+// The kernels used by default. Can be forced with the VISUALIZER_SIMD build option
+const SimdKernels& GetSimdKernels();
+
+// The kernels of the given level, or of the next lower level that was built
+const SimdKernels& GetSimdKernels(SimdLevel level);
+
+extern const SimdKernels scalarKernels;
+extern const SimdKernels sse2Kernels;
+extern const SimdKernels avx2Kernels;
+extern const SimdKernels avx512Kernels;
\ No newline at end of file
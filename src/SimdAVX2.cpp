@@ -0,0 +1,318 @@
+#include "Simd.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+#include <immintrin.h>
+
+// Multiplies four pairs of interleaved complex numbers
+static inline __m256 ComplexMultiply(__m256 a, __m256 w)
+{
+    __m256 wr = _mm256_moveldup_ps(w);
+    __m256 wi = _mm256_movehdup_ps(w);
+    __m256 swapped = _mm256_permute_ps(a, _MM_SHUFFLE(2, 3, 0, 1));
+
+    return _mm256_fmaddsub_ps(a, wr, _mm256_mul_ps(swapped, wi));
+}
+
+static void Butterflies(float* data, size_t N, size_t half, const float* twiddles)
+{
+    if(half < 4)
+    {
+        sse2Kernels.Butterflies(data, N, half, twiddles);
+        return;
+    }
+
+    size_t span = half << 1;
+    for(size_t block = 0; block < N; block += span)
+    {
+        float* first = data + 2 * block;
+        float* second = first + 2 * half;
+
+        for(size_t k = 0; k < 2 * half; k += 8)
+        {
+            __m256 q = ComplexMultiply(_mm256_loadu_ps(second + k), _mm256_loadu_ps(twiddles + k));
+            __m256 p = _mm256_loadu_ps(first + k);
+
+            _mm256_storeu_ps(first + k, _mm256_add_ps(p, q));
+            _mm256_storeu_ps(second + k, _mm256_sub_ps(p, q));
+        }
+    }
+}
+
+static void SparseMultiply(const SparseSpan* spans, size_t rows, const float* weights, const float* input, float* output)
+{
+    for(size_t row = 0; row < rows; row++)
+    {
+        const float* w = weights + spans[row].offset;
+        const float* x = input + spans[row].start;
+        uint32_t length = spans[row].length;
+
+        __m256 acc = _mm256_setzero_ps();
+        uint32_t i = 0;
+        for(; i + 8 <= length; i += 8)
+            acc = _mm256_fmadd_ps(_mm256_loadu_ps(w + i), _mm256_loadu_ps(x + i), acc);
+
+        // Horizontal sum
+        __m128 half = _mm_add_ps(_mm256_castps256_ps128(acc), _mm256_extractf128_ps(acc, 1));
+        half = _mm_add_ps(half, _mm_movehl_ps(half, half));
+        half = _mm_add_ss(half, _mm_movehdup_ps(half));
+
+        float sum = _mm_cvtss_f32(half);
+        for(; i < length; i++)
+            sum += w[i] * x[i];
+
+        output[row] = sum;
+    }
+}
+
+// Loads eight samples and converts them to float. Big endian samples and the
+// packed 24 bit samples are rearranged with byte shuffles, which work on the
+// two 128 bit halves separately
+template<SampleFormat Format, bool BigEndian>
+static inline __m256 LoadSamples(const uint8_t* ptr)
+{
+    if constexpr(Format == SampleFormat::U8)
+    {
+        __m256i x = _mm256_cvtepu8_epi32(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(ptr)));
+        x = _mm256_sub_epi32(x, _mm256_set1_epi32(128));
+
+        return _mm256_mul_ps(_mm256_cvtepi32_ps(x), _mm256_set1_ps(1.0f / 128.0f));
+    }
+    else if constexpr(Format == SampleFormat::S16)
+    {
+        __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(ptr));
+        if constexpr(BigEndian)
+            x = _mm_shuffle_epi8(x, _mm_setr_epi8(1, 0, 3, 2, 5, 4, 7, 6, 9, 8, 11, 10, 13, 12, 15, 14));
+
+        return _mm256_mul_ps(_mm256_cvtepi32_ps(_mm256_cvtepi16_epi32(x)), _mm256_set1_ps(1.0f / 32768.0f));
+    }
+    else if constexpr(Format == SampleFormat::S24)
+    {
+        // Each half holds four samples in its lower twelve bytes. They go into
+        // the upper three bytes of a lane, the arithmetic shift sign extends
+        const __m256i unpack = BigEndian ?
+            _mm256_setr_epi8(-1, 2, 1, 0, -1, 5, 4, 3, -1, 8, 7, 6, -1, 11, 10, 9, -1, 2, 1, 0, -1, 5, 4, 3, -1, 8, 7, 6, -1, 11, 10, 9) :
+            _mm256_setr_epi8(-1, 0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11, -1, 0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11);
+
+        __m256i x = _mm256_loadu2_m128i(reinterpret_cast<const __m128i*>(ptr + 12), reinterpret_cast<const __m128i*>(ptr));
+        x = _mm256_srai_epi32(_mm256_shuffle_epi8(x, unpack), 8);
+
+        return _mm256_mul_ps(_mm256_cvtepi32_ps(x), _mm256_set1_ps(1.0f / 8388608.0f));
+    }
+    else
+    {
+        const __m256i swap = _mm256_setr_epi8(3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12, 3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12);
+
+        __m256i x = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(ptr));
+        if constexpr(BigEndian)
+            x = _mm256_shuffle_epi8(x, swap);
+
+        if constexpr(Format == SampleFormat::S32)
+            return _mm256_mul_ps(_mm256_cvtepi32_ps(x), _mm256_set1_ps(1.0f / 2147483648.0f));
+        else
+            return _mm256_castsi256_ps(x);
+    }
+}
+
+template<SampleFormat Format, bool BigEndian>
+static void ConvertPcm(const uint8_t* input, size_t samples, bool downmix, float* output)
+{
+    const size_t bytes = GetBytesPerSample(Format);
+
+    // The second half of a 24 bit load reads four bytes past its samples
+    size_t vectorSamples = samples;
+    if(Format == SampleFormat::S24)
+        vectorSamples = (samples >= 2) ? samples - 2 : 0;
+
+    size_t i = 0;
+    if(downmix)
+    {
+        // Sixteen samples are eight stereo pairs. The in-lane shuffles leave
+        // the pairs as 0 1 4 5 2 3 6 7, the permute restores the order
+        const __m256 half = _mm256_set1_ps(0.5f);
+        for(; i + 16 <= vectorSamples; i += 16)
+        {
+            __m256 a = LoadSamples<Format, BigEndian>(input + i * bytes);
+            __m256 b = LoadSamples<Format, BigEndian>(input + (i + 8) * bytes);
+
+            __m256 left = _mm256_shuffle_ps(a, b, _MM_SHUFFLE(2, 0, 2, 0));
+            __m256 right = _mm256_shuffle_ps(a, b, _MM_SHUFFLE(3, 1, 3, 1));
+            __m256 mixed = _mm256_mul_ps(_mm256_add_ps(left, right), half);
+
+            mixed = _mm256_castpd_ps(_mm256_permute4x64_pd(_mm256_castps_pd(mixed), _MM_SHUFFLE(3, 1, 2, 0)));
+            _mm256_storeu_ps(output + i / 2, mixed);
+        }
+
+        scalarKernels.ConvertPcm(input + i * bytes, samples - i, Format, BigEndian, true, output + i / 2);
+    }
+    else
+    {
+        for(; i + 8 <= vectorSamples; i += 8)
+            _mm256_storeu_ps(output + i, LoadSamples<Format, BigEndian>(input + i * bytes));
+
+        scalarKernels.ConvertPcm(input + i * bytes, samples - i, Format, BigEndian, false, output + i);
+    }
+}
+
+template<SampleFormat Format>
+static void ConvertPcm(const uint8_t* input, size_t samples, bool bigEndian, bool downmix, float* output)
+{
+    if(bigEndian)
+        ConvertPcm<Format, true>(input, samples, downmix, output);
+    else
+        ConvertPcm<Format, false>(input, samples, downmix, output);
+}
+
+static void ConvertPcm(const uint8_t* input, size_t samples, SampleFormat format, bool bigEndian, bool downmix, float* output)
+{
+    switch(format)
+    {
+    case SampleFormat::U8:      ConvertPcm<SampleFormat::U8>(input, samples, bigEndian, downmix, output); break;
+    case SampleFormat::S16:     ConvertPcm<SampleFormat::S16>(input, samples, bigEndian, downmix, output); break;
+    case SampleFormat::S24:     ConvertPcm<SampleFormat::S24>(input, samples, bigEndian, downmix, output); break;
+    case SampleFormat::S32:     ConvertPcm<SampleFormat::S32>(input, samples, bigEndian, downmix, output); break;
+    case SampleFormat::F32:     ConvertPcm<SampleFormat::F32>(input, samples, bigEndian, downmix, output); break;
+    }
+}
+
+static void Statistics(const float* input, size_t count, float* peak, float* sumSquares)
+{
+    const __m256 absMask = _mm256_castsi256_ps(_mm256_set1_epi32(0x7FFFFFFF));
+
+    __m256 largest0 = _mm256_setzero_ps(), largest1 = _mm256_setzero_ps();
+    __m256 sum0 = _mm256_setzero_ps(), sum1 = _mm256_setzero_ps();
+
+    size_t i = 0;
+    for(; i + 16 <= count; i += 16)
+    {
+        __m256 a = _mm256_loadu_ps(input + i);
+        __m256 b = _mm256_loadu_ps(input + i + 8);
+
+        largest0 = _mm256_max_ps(largest0, _mm256_and_ps(a, absMask));
+        largest1 = _mm256_max_ps(largest1, _mm256_and_ps(b, absMask));
+        sum0 = _mm256_fmadd_ps(a, a, sum0);
+        sum1 = _mm256_fmadd_ps(b, b, sum1);
+    }
+
+    __m256 largest = _mm256_max_ps(largest0, largest1);
+    __m128 half = _mm_max_ps(_mm256_castps256_ps128(largest), _mm256_extractf128_ps(largest, 1));
+    half = _mm_max_ps(half, _mm_movehl_ps(half, half));
+    half = _mm_max_ss(half, _mm_movehdup_ps(half));
+
+    __m256 sum = _mm256_add_ps(sum0, sum1);
+    __m128 sumHalf = _mm_add_ps(_mm256_castps256_ps128(sum), _mm256_extractf128_ps(sum, 1));
+    sumHalf = _mm_add_ps(sumHalf, _mm_movehl_ps(sumHalf, sumHalf));
+    sumHalf = _mm_add_ss(sumHalf, _mm_movehdup_ps(sumHalf));
+
+    float tailPeak, tailSum;
+    sse2Kernels.Statistics(input + i, count - i, &tailPeak, &tailSum);
+
+    *peak = std::max(_mm_cvtss_f32(half), tailPeak);
+    *sumSquares = _mm_cvtss_f32(sumHalf) + tailSum;
+}
+
+static inline __m256i HalfFromFloat(__m256 value)
+{
+    __m256i x = _mm256_castps_si256(value);
+    __m256i sign = _mm256_and_si256(x, _mm256_set1_epi32((int)0x80000000u));
+    x = _mm256_xor_si256(x, sign);
+
+    __m256i special = _mm256_or_si256(
+        _mm256_set1_epi32(0x7C00),
+        _mm256_and_si256(_mm256_cmpgt_epi32(x, _mm256_set1_epi32(0x7F800000)), _mm256_set1_epi32(0x0200))
+    );
+
+    __m256 shifted = _mm256_add_ps(_mm256_castsi256_ps(x), _mm256_set1_ps(0.5f));
+    __m256i subnormal = _mm256_sub_epi32(_mm256_castps_si256(shifted), _mm256_set1_epi32(0x3F000000));
+
+    __m256i odd = _mm256_and_si256(_mm256_srli_epi32(x, 13), _mm256_set1_epi32(1));
+    __m256i normal = _mm256_add_epi32(x, _mm256_set1_epi32((int)(((uint32_t)(15 - 127) << 23) + 0xFFF)));
+    normal = _mm256_srli_epi32(_mm256_add_epi32(normal, odd), 13);
+
+    __m256i finite = _mm256_blendv_epi8(normal, subnormal, _mm256_cmpgt_epi32(_mm256_set1_epi32(0x38800000), x));
+    __m256i result = _mm256_blendv_epi8(special, finite, _mm256_cmpgt_epi32(_mm256_set1_epi32(0x47800000), x));
+
+    return _mm256_or_si256(result, _mm256_srli_epi32(sign, 16));
+}
+
+// Packs two vectors of values below 2^16 into sixteen 16 bit lanes. The pack
+// works within 128 bit lanes, the permute puts the quarters back in order
+static inline __m256i Pack16(__m256i a, __m256i b)
+{
+    return _mm256_permute4x64_epi64(_mm256_packus_epi32(a, b), _MM_SHUFFLE(3, 1, 2, 0));
+}
+
+static void FloatToHalf(const float* input, size_t count, uint16_t* output)
+{
+    size_t i = 0;
+    for(; i + 16 <= count; i += 16)
+    {
+        __m256i low = HalfFromFloat(_mm256_loadu_ps(input + i));
+        __m256i high = HalfFromFloat(_mm256_loadu_ps(input + i + 8));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(output + i), Pack16(low, high));
+    }
+
+    sse2Kernels.FloatToHalf(input + i, count - i, output + i);
+}
+
+static inline __m256 Log2(__m256 x)
+{
+    __m256i bits = _mm256_castps_si256(x);
+    __m256 exponent = _mm256_cvtepi32_ps(_mm256_sub_epi32(_mm256_srli_epi32(bits, 23), _mm256_set1_epi32(127)));
+    __m256 m = _mm256_castsi256_ps(_mm256_or_si256(_mm256_and_si256(bits, _mm256_set1_epi32(0x007FFFFF)), _mm256_set1_epi32(0x3F800000)));
+
+    __m256 large = _mm256_cmp_ps(m, _mm256_set1_ps(1.41421356f), _CMP_GT_OQ);
+    m = _mm256_blendv_ps(m, _mm256_mul_ps(m, _mm256_set1_ps(0.5f)), large);
+    exponent = _mm256_add_ps(exponent, _mm256_and_ps(large, _mm256_set1_ps(1.0f)));
+
+    const __m256 one = _mm256_set1_ps(1.0f);
+    __m256 t = _mm256_div_ps(_mm256_sub_ps(m, one), _mm256_add_ps(m, one));
+    __m256 t2 = _mm256_mul_ps(t, t);
+
+    __m256 series = _mm256_fmadd_ps(t2, _mm256_set1_ps(0.412198583f), _mm256_set1_ps(0.577078016f));
+    series = _mm256_fmadd_ps(t2, series, _mm256_set1_ps(0.961796694f));
+    series = _mm256_fmadd_ps(t2, series, _mm256_set1_ps(2.88539008f));
+
+    return _mm256_fmadd_ps(t, series, exponent);
+}
+
+static void QuantizeLog(const float* input, size_t count, float logMin, float scale, unsigned int bits, void* output)
+{
+    const __m256 floor = _mm256_set1_ps(std::exp2(logMin));
+    const __m256 minimum = _mm256_set1_ps(logMin);
+    const __m256 factor = _mm256_set1_ps(scale);
+    const __m256 maxCode = _mm256_set1_ps((float)((1u << bits) - 1));
+
+    auto quantize = [&](const float* values) {
+        __m256 code = _mm256_mul_ps(_mm256_sub_ps(Log2(_mm256_max_ps(_mm256_loadu_ps(values), floor)), minimum), factor);
+        code = _mm256_min_ps(_mm256_max_ps(code, _mm256_setzero_ps()), maxCode);
+        return _mm256_cvttps_epi32(_mm256_add_ps(code, _mm256_set1_ps(0.5f)));
+    };
+
+    size_t i = 0;
+    for(; i + 16 <= count; i += 16)
+    {
+        __m256i codes = Pack16(quantize(input + i), quantize(input + i + 8));
+
+        if(bits == 8)
+        {
+            __m128i bytes = _mm_packus_epi16(_mm256_castsi256_si128(codes), _mm256_extracti128_si256(codes, 1));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(static_cast<uint8_t*>(output) + i), bytes);
+        }
+        else
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(static_cast<uint16_t*>(output) + i), codes);
+    }
+
+    sse2Kernels.QuantizeLog(input + i, count - i, logMin, scale, bits, static_cast<uint8_t*>(output) + i * (bits / 8));
+}
+
+extern const SimdKernels avx2Kernels = {
+    SimdLevel::AVX2, "AVX2",
+    &Butterflies,
+    &SparseMultiply,
+    &ConvertPcm,
+    &Statistics,
+    &FloatToHalf,
+    &QuantizeLog
+};
\ No newline at end of file
@@ -0,0 +1,186 @@
+#include "Simd.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+#include <immintrin.h>
+
+// Multiplies eight pairs of interleaved complex numbers
+static inline __m512 ComplexMultiply(__m512 a, __m512 w)
+{
+    __m512 wr = _mm512_moveldup_ps(w);
+    __m512 wi = _mm512_movehdup_ps(w);
+    __m512 swapped = _mm512_permute_ps(a, _MM_SHUFFLE(2, 3, 0, 1));
+
+    return _mm512_fmaddsub_ps(a, wr, _mm512_mul_ps(swapped, wi));
+}
+
+static void Butterflies(float* data, size_t N, size_t half, const float* twiddles)
+{
+    if(half < 8)
+    {
+        avx2Kernels.Butterflies(data, N, half, twiddles);
+        return;
+    }
+
+    size_t span = half << 1;
+    for(size_t block = 0; block < N; block += span)
+    {
+        float* first = data + 2 * block;
+        float* second = first + 2 * half;
+
+        for(size_t k = 0; k < 2 * half; k += 16)
+        {
+            __m512 q = ComplexMultiply(_mm512_loadu_ps(second + k), _mm512_loadu_ps(twiddles + k));
+            __m512 p = _mm512_loadu_ps(first + k);
+
+            _mm512_storeu_ps(first + k, _mm512_add_ps(p, q));
+            _mm512_storeu_ps(second + k, _mm512_sub_ps(p, q));
+        }
+    }
+}
+
+static void SparseMultiply(const SparseSpan* spans, size_t rows, const float* weights, const float* input, float* output)
+{
+    for(size_t row = 0; row < rows; row++)
+    {
+        const float* w = weights + spans[row].offset;
+        const float* x = input + spans[row].start;
+        uint32_t length = spans[row].length;
+
+        __m512 acc = _mm512_setzero_ps();
+        uint32_t i = 0;
+        for(; i + 16 <= length; i += 16)
+            acc = _mm512_fmadd_ps(_mm512_loadu_ps(w + i), _mm512_loadu_ps(x + i), acc);
+
+        // Masked loads handle the tail, so short rows need no scalar loop
+        if(i < length)
+        {
+            __mmask16 mask = (__mmask16)((1u << (length - i)) - 1);
+            acc = _mm512_fmadd_ps(_mm512_maskz_loadu_ps(mask, w + i), _mm512_maskz_loadu_ps(mask, x + i), acc);
+        }
+
+        output[row] = _mm512_reduce_add_ps(acc);
+    }
+}
+
+// Conversion is bound by memory bandwidth, and the byte shuffles for big endian
+// and 24 bit samples would need AVX-512BW on top. The AVX2 kernel it is
+static void ConvertPcm(const uint8_t* input, size_t samples, SampleFormat format, bool bigEndian, bool downmix, float* output)
+{
+    avx2Kernels.ConvertPcm(input, samples, format, bigEndian, downmix, output);
+}
+
+static void Statistics(const float* input, size_t count, float* peak, float* sumSquares)
+{
+    __m512 largest0 = _mm512_setzero_ps(), largest1 = _mm512_setzero_ps();
+    __m512 sum0 = _mm512_setzero_ps(), sum1 = _mm512_setzero_ps();
+
+    size_t i = 0;
+    for(; i + 32 <= count; i += 32)
+    {
+        __m512 a = _mm512_loadu_ps(input + i);
+        __m512 b = _mm512_loadu_ps(input + i + 16);
+
+        largest0 = _mm512_max_ps(largest0, _mm512_abs_ps(a));
+        largest1 = _mm512_max_ps(largest1, _mm512_abs_ps(b));
+        sum0 = _mm512_fmadd_ps(a, a, sum0);
+        sum1 = _mm512_fmadd_ps(b, b, sum1);
+    }
+
+    float tailPeak, tailSum;
+    avx2Kernels.Statistics(input + i, count - i, &tailPeak, &tailSum);
+
+    *peak = std::max(_mm512_reduce_max_ps(_mm512_max_ps(largest0, largest1)), tailPeak);
+    *sumSquares = _mm512_reduce_add_ps(_mm512_add_ps(sum0, sum1)) + tailSum;
+}
+
+static inline __m512i HalfFromFloat(__m512 value)
+{
+    __m512i x = _mm512_castps_si512(value);
+    __m512i sign = _mm512_and_si512(x, _mm512_set1_epi32((int)0x80000000u));
+    x = _mm512_xor_si512(x, sign);
+
+    __m512i special = _mm512_mask_mov_epi32(
+        _mm512_set1_epi32(0x7C00),
+        _mm512_cmpgt_epi32_mask(x, _mm512_set1_epi32(0x7F800000)), _mm512_set1_epi32(0x7E00)
+    );
+
+    __m512 shifted = _mm512_add_ps(_mm512_castsi512_ps(x), _mm512_set1_ps(0.5f));
+    __m512i subnormal = _mm512_sub_epi32(_mm512_castps_si512(shifted), _mm512_set1_epi32(0x3F000000));
+
+    __m512i odd = _mm512_and_si512(_mm512_srli_epi32(x, 13), _mm512_set1_epi32(1));
+    __m512i normal = _mm512_add_epi32(x, _mm512_set1_epi32((int)(((uint32_t)(15 - 127) << 23) + 0xFFF)));
+    normal = _mm512_srli_epi32(_mm512_add_epi32(normal, odd), 13);
+
+    __m512i finite = _mm512_mask_blend_epi32(_mm512_cmplt_epi32_mask(x, _mm512_set1_epi32(0x38800000)), normal, subnormal);
+    __m512i result = _mm512_mask_blend_epi32(_mm512_cmplt_epi32_mask(x, _mm512_set1_epi32(0x47800000)), special, finite);
+
+    return _mm512_or_si512(result, _mm512_srli_epi32(sign, 16));
+}
+
+static void FloatToHalf(const float* input, size_t count, uint16_t* output)
+{
+    size_t i = 0;
+    for(; i + 16 <= count; i += 16)
+    {
+        __m256i halves = _mm512_cvtepi32_epi16(HalfFromFloat(_mm512_loadu_ps(input + i)));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(output + i), halves);
+    }
+
+    avx2Kernels.FloatToHalf(input + i, count - i, output + i);
+}
+
+static inline __m512 Log2(__m512 x)
+{
+    __m512i bits = _mm512_castps_si512(x);
+    __m512 exponent = _mm512_cvtepi32_ps(_mm512_sub_epi32(_mm512_srli_epi32(bits, 23), _mm512_set1_epi32(127)));
+    __m512 m = _mm512_castsi512_ps(_mm512_or_si512(_mm512_and_si512(bits, _mm512_set1_epi32(0x007FFFFF)), _mm512_set1_epi32(0x3F800000)));
+
+    __mmask16 large = _mm512_cmp_ps_mask(m, _mm512_set1_ps(1.41421356f), _CMP_GT_OQ);
+    m = _mm512_mask_mul_ps(m, large, m, _mm512_set1_ps(0.5f));
+    exponent = _mm512_mask_add_ps(exponent, large, exponent, _mm512_set1_ps(1.0f));
+
+    const __m512 one = _mm512_set1_ps(1.0f);
+    __m512 t = _mm512_div_ps(_mm512_sub_ps(m, one), _mm512_add_ps(m, one));
+    __m512 t2 = _mm512_mul_ps(t, t);
+
+    __m512 series = _mm512_fmadd_ps(t2, _mm512_set1_ps(0.412198583f), _mm512_set1_ps(0.577078016f));
+    series = _mm512_fmadd_ps(t2, series, _mm512_set1_ps(0.961796694f));
+    series = _mm512_fmadd_ps(t2, series, _mm512_set1_ps(2.88539008f));
+
+    return _mm512_fmadd_ps(t, series, exponent);
+}
+
+static void QuantizeLog(const float* input, size_t count, float logMin, float scale, unsigned int bits, void* output)
+{
+    const __m512 floor = _mm512_set1_ps(std::exp2(logMin));
+    const __m512 minimum = _mm512_set1_ps(logMin);
+    const __m512 factor = _mm512_set1_ps(scale);
+    const __m512 maxCode = _mm512_set1_ps((float)((1u << bits) - 1));
+
+    size_t i = 0;
+    for(; i + 16 <= count; i += 16)
+    {
+        __m512 code = _mm512_mul_ps(_mm512_sub_ps(Log2(_mm512_max_ps(_mm512_loadu_ps(input + i), floor)), minimum), factor);
+        code = _mm512_min_ps(_mm512_max_ps(code, _mm512_setzero_ps()), maxCode);
+        __m512i codes = _mm512_cvttps_epi32(_mm512_add_ps(code, _mm512_set1_ps(0.5f)));
+
+        if(bits == 8)
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(static_cast<uint8_t*>(output) + i), _mm512_cvtepi32_epi8(codes));
+        else
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(static_cast<uint16_t*>(output) + i), _mm512_cvtepi32_epi16(codes));
+    }
+
+    avx2Kernels.QuantizeLog(input + i, count - i, logMin, scale, bits, static_cast<uint8_t*>(output) + i * (bits / 8));
+}
+
+extern const SimdKernels avx512Kernels = {
+    SimdLevel::AVX512, "AVX-512",
+    &Butterflies,
+    &SparseMultiply,
+    &ConvertPcm,
+    &Statistics,
+    &FloatToHalf,
+    &QuantizeLog
+};
\ No newline at end of file
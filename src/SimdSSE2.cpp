@@ -0,0 +1,332 @@
+#include "Simd.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#include <emmintrin.h>
+
+// Multiplies two pairs of interleaved complex numbers
+static inline __m128 ComplexMultiply(__m128 a, __m128 w)
+{
+    const __m128 negateReal = _mm_castsi128_ps(_mm_setr_epi32(0x80000000, 0, 0x80000000, 0));
+
+    __m128 wr = _mm_shuffle_ps(w, w, _MM_SHUFFLE(2, 2, 0, 0));
+    __m128 wi = _mm_shuffle_ps(w, w, _MM_SHUFFLE(3, 3, 1, 1));
+    __m128 swapped = _mm_shuffle_ps(a, a, _MM_SHUFFLE(2, 3, 0, 1));
+
+    return _mm_add_ps(_mm_mul_ps(a, wr), _mm_xor_ps(_mm_mul_ps(swapped, wi), negateReal));
+}
+
+static void Butterflies(float* data, size_t N, size_t half, const float* twiddles)
+{
+    if(half < 2)
+    {
+        scalarKernels.Butterflies(data, N, half, twiddles);
+        return;
+    }
+
+    size_t span = half << 1;
+    for(size_t block = 0; block < N; block += span)
+    {
+        float* first = data + 2 * block;
+        float* second = first + 2 * half;
+
+        for(size_t k = 0; k < 2 * half; k += 4)
+        {
+            __m128 q = ComplexMultiply(_mm_loadu_ps(second + k), _mm_loadu_ps(twiddles + k));
+            __m128 p = _mm_loadu_ps(first + k);
+
+            _mm_storeu_ps(first + k, _mm_add_ps(p, q));
+            _mm_storeu_ps(second + k, _mm_sub_ps(p, q));
+        }
+    }
+}
+
+static void SparseMultiply(const SparseSpan* spans, size_t rows, const float* weights, const float* input, float* output)
+{
+    for(size_t row = 0; row < rows; row++)
+    {
+        const float* w = weights + spans[row].offset;
+        const float* x = input + spans[row].start;
+        uint32_t length = spans[row].length;
+
+        __m128 acc = _mm_setzero_ps();
+        uint32_t i = 0;
+        for(; i + 4 <= length; i += 4)
+            acc = _mm_add_ps(acc, _mm_mul_ps(_mm_loadu_ps(w + i), _mm_loadu_ps(x + i)));
+
+        // Horizontal sum
+        acc = _mm_add_ps(acc, _mm_movehl_ps(acc, acc));
+        acc = _mm_add_ss(acc, _mm_shuffle_ps(acc, acc, _MM_SHUFFLE(1, 1, 1, 1)));
+
+        float sum = _mm_cvtss_f32(acc);
+        for(; i < length; i++)
+            sum += w[i] * x[i];
+
+        output[row] = sum;
+    }
+}
+
+// SSE2 has no byte shuffle, so big endian samples are swapped with shifts
+static inline __m128i Swap16(__m128i x)
+{
+    return _mm_or_si128(_mm_slli_epi16(x, 8), _mm_srli_epi16(x, 8));
+}
+
+static inline __m128i Swap32(__m128i x)
+{
+    x = Swap16(x);
+    return _mm_or_si128(_mm_slli_epi32(x, 16), _mm_srli_epi32(x, 16));
+}
+
+// Loads four samples and converts them to float
+template<SampleFormat Format, bool BigEndian>
+static inline __m128 LoadSamples(const uint8_t* ptr)
+{
+    if constexpr(Format == SampleFormat::U8)
+    {
+        int32_t packed;
+        std::memcpy(&packed, ptr, sizeof(packed));
+
+        __m128i zero = _mm_setzero_si128();
+        __m128i x = _mm_unpacklo_epi16(_mm_unpacklo_epi8(_mm_cvtsi32_si128(packed), zero), zero);
+        x = _mm_sub_epi32(x, _mm_set1_epi32(128));
+
+        return _mm_mul_ps(_mm_cvtepi32_ps(x), _mm_set1_ps(1.0f / 128.0f));
+    }
+    else if constexpr(Format == SampleFormat::S16)
+    {
+        __m128i x = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(ptr));
+        if constexpr(BigEndian)
+            x = Swap16(x);
+
+        // Into the upper halves, the arithmetic shift then sign extends
+        x = _mm_srai_epi32(_mm_unpacklo_epi16(_mm_setzero_si128(), x), 16);
+
+        return _mm_mul_ps(_mm_cvtepi32_ps(x), _mm_set1_ps(1.0f / 32768.0f));
+    }
+    else if constexpr(Format == SampleFormat::S32)
+    {
+        __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(ptr));
+        if constexpr(BigEndian)
+            x = Swap32(x);
+
+        return _mm_mul_ps(_mm_cvtepi32_ps(x), _mm_set1_ps(1.0f / 2147483648.0f));
+    }
+    else
+    {
+        __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(ptr));
+        if constexpr(BigEndian)
+            x = Swap32(x);
+
+        return _mm_castsi128_ps(x);
+    }
+}
+
+template<SampleFormat Format, bool BigEndian>
+static void ConvertPcm(const uint8_t* input, size_t samples, bool downmix, float* output)
+{
+    const size_t bytes = GetBytesPerSample(Format);
+    size_t i = 0;
+
+    if(downmix)
+    {
+        // Eight samples are four stereo pairs
+        const __m128 half = _mm_set1_ps(0.5f);
+        for(; i + 8 <= samples; i += 8)
+        {
+            __m128 a = LoadSamples<Format, BigEndian>(input + i * bytes);
+            __m128 b = LoadSamples<Format, BigEndian>(input + (i + 4) * bytes);
+
+            __m128 left = _mm_shuffle_ps(a, b, _MM_SHUFFLE(2, 0, 2, 0));
+            __m128 right = _mm_shuffle_ps(a, b, _MM_SHUFFLE(3, 1, 3, 1));
+            _mm_storeu_ps(output + i / 2, _mm_mul_ps(_mm_add_ps(left, right), half));
+        }
+
+        scalarKernels.ConvertPcm(input + i * bytes, samples - i, Format, BigEndian, true, output + i / 2);
+    }
+    else
+    {
+        for(; i + 4 <= samples; i += 4)
+            _mm_storeu_ps(output + i, LoadSamples<Format, BigEndian>(input + i * bytes));
+
+        scalarKernels.ConvertPcm(input + i * bytes, samples - i, Format, BigEndian, false, output + i);
+    }
+}
+
+template<SampleFormat Format>
+static void ConvertPcm(const uint8_t* input, size_t samples, bool bigEndian, bool downmix, float* output)
+{
+    if(bigEndian)
+        ConvertPcm<Format, true>(input, samples, downmix, output);
+    else
+        ConvertPcm<Format, false>(input, samples, downmix, output);
+}
+
+static void ConvertPcm(const uint8_t* input, size_t samples, SampleFormat format, bool bigEndian, bool downmix, float* output)
+{
+    switch(format)
+    {
+    case SampleFormat::U8:      ConvertPcm<SampleFormat::U8>(input, samples, bigEndian, downmix, output); break;
+    case SampleFormat::S16:     ConvertPcm<SampleFormat::S16>(input, samples, bigEndian, downmix, output); break;
+    case SampleFormat::S32:     ConvertPcm<SampleFormat::S32>(input, samples, bigEndian, downmix, output); break;
+    case SampleFormat::F32:     ConvertPcm<SampleFormat::F32>(input, samples, bigEndian, downmix, output); break;
+
+    // Unpacking three byte samples needs a byte shuffle
+    default:
+        scalarKernels.ConvertPcm(input, samples, format, bigEndian, downmix, output);
+        break;
+    }
+}
+
+static void Statistics(const float* input, size_t count, float* peak, float* sumSquares)
+{
+    const __m128 absMask = _mm_castsi128_ps(_mm_set1_epi32(0x7FFFFFFF));
+
+    // Two accumulators each, to hide the latency of the adds
+    __m128 largest0 = _mm_setzero_ps(), largest1 = _mm_setzero_ps();
+    __m128 sum0 = _mm_setzero_ps(), sum1 = _mm_setzero_ps();
+
+    size_t i = 0;
+    for(; i + 8 <= count; i += 8)
+    {
+        __m128 a = _mm_loadu_ps(input + i);
+        __m128 b = _mm_loadu_ps(input + i + 4);
+
+        largest0 = _mm_max_ps(largest0, _mm_and_ps(a, absMask));
+        largest1 = _mm_max_ps(largest1, _mm_and_ps(b, absMask));
+        sum0 = _mm_add_ps(sum0, _mm_mul_ps(a, a));
+        sum1 = _mm_add_ps(sum1, _mm_mul_ps(b, b));
+    }
+
+    __m128 largest = _mm_max_ps(largest0, largest1);
+    largest = _mm_max_ps(largest, _mm_movehl_ps(largest, largest));
+    largest = _mm_max_ss(largest, _mm_shuffle_ps(largest, largest, _MM_SHUFFLE(1, 1, 1, 1)));
+
+    __m128 sum = _mm_add_ps(sum0, sum1);
+    sum = _mm_add_ps(sum, _mm_movehl_ps(sum, sum));
+    sum = _mm_add_ss(sum, _mm_shuffle_ps(sum, sum, _MM_SHUFFLE(1, 1, 1, 1)));
+
+    float tailPeak, tailSum;
+    scalarKernels.Statistics(input + i, count - i, &tailPeak, &tailSum);
+
+    *peak = std::max(_mm_cvtss_f32(largest), tailPeak);
+    *sumSquares = _mm_cvtss_f32(sum) + tailSum;
+}
+
+// Blends the lanes of a where mask is set with those of b
+static inline __m128i Select(__m128i mask, __m128i a, __m128i b)
+{
+    return _mm_or_si128(_mm_and_si128(mask, a), _mm_andnot_si128(mask, b));
+}
+
+// Four floats to half precision in the low 16 bits of each lane, the same
+// rounding as the scalar kernel
+static inline __m128i HalfFromFloat(__m128 value)
+{
+    const __m128i signMask = _mm_set1_epi32((int)0x80000000u);
+
+    __m128i x = _mm_castps_si128(value);
+    __m128i sign = _mm_and_si128(x, signMask);
+    x = _mm_xor_si128(x, sign);
+
+    __m128i special = _mm_or_si128(
+        _mm_set1_epi32(0x7C00),
+        _mm_and_si128(_mm_cmpgt_epi32(x, _mm_set1_epi32(0x7F800000)), _mm_set1_epi32(0x0200))
+    );
+
+    __m128 shifted = _mm_add_ps(_mm_castsi128_ps(x), _mm_set1_ps(0.5f));
+    __m128i subnormal = _mm_sub_epi32(_mm_castps_si128(shifted), _mm_set1_epi32(0x3F000000));
+
+    __m128i odd = _mm_and_si128(_mm_srli_epi32(x, 13), _mm_set1_epi32(1));
+    __m128i normal = _mm_add_epi32(x, _mm_set1_epi32((int)(((uint32_t)(15 - 127) << 23) + 0xFFF)));
+    normal = _mm_srli_epi32(_mm_add_epi32(normal, odd), 13);
+
+    __m128i finite = Select(_mm_cmplt_epi32(x, _mm_set1_epi32(0x38800000)), subnormal, normal);
+    __m128i result = Select(_mm_cmplt_epi32(x, _mm_set1_epi32(0x47800000)), finite, special);
+
+    return _mm_or_si128(result, _mm_srli_epi32(sign, 16));
+}
+
+// Packs two vectors of values below 2^16 into eight 16 bit lanes. SSE2 only
+// has the signed saturating pack, so the values are sign extended first
+static inline __m128i Pack16(__m128i a, __m128i b)
+{
+    a = _mm_srai_epi32(_mm_slli_epi32(a, 16), 16);
+    b = _mm_srai_epi32(_mm_slli_epi32(b, 16), 16);
+    return _mm_packs_epi32(a, b);
+}
+
+static void FloatToHalf(const float* input, size_t count, uint16_t* output)
+{
+    size_t i = 0;
+    for(; i + 8 <= count; i += 8)
+    {
+        __m128i low = HalfFromFloat(_mm_loadu_ps(input + i));
+        __m128i high = HalfFromFloat(_mm_loadu_ps(input + i + 4));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(output + i), Pack16(low, high));
+    }
+
+    scalarKernels.FloatToHalf(input + i, count - i, output + i);
+}
+
+// Vector version of the scalar log2, same operations in the same order
+static inline __m128 Log2(__m128 x)
+{
+    __m128i bits = _mm_castps_si128(x);
+    __m128 exponent = _mm_cvtepi32_ps(_mm_sub_epi32(_mm_srli_epi32(bits, 23), _mm_set1_epi32(127)));
+    __m128 m = _mm_castsi128_ps(_mm_or_si128(_mm_and_si128(bits, _mm_set1_epi32(0x007FFFFF)), _mm_set1_epi32(0x3F800000)));
+
+    __m128 large = _mm_cmpgt_ps(m, _mm_set1_ps(1.41421356f));
+    m = _mm_or_ps(_mm_and_ps(large, _mm_mul_ps(m, _mm_set1_ps(0.5f))), _mm_andnot_ps(large, m));
+    exponent = _mm_add_ps(exponent, _mm_and_ps(large, _mm_set1_ps(1.0f)));
+
+    const __m128 one = _mm_set1_ps(1.0f);
+    __m128 t = _mm_div_ps(_mm_sub_ps(m, one), _mm_add_ps(m, one));
+    __m128 t2 = _mm_mul_ps(t, t);
+
+    __m128 series = _mm_add_ps(_mm_set1_ps(0.577078016f), _mm_mul_ps(t2, _mm_set1_ps(0.412198583f)));
+    series = _mm_add_ps(_mm_set1_ps(0.961796694f), _mm_mul_ps(t2, series));
+    series = _mm_add_ps(_mm_set1_ps(2.88539008f), _mm_mul_ps(t2, series));
+
+    return _mm_add_ps(exponent, _mm_mul_ps(t, series));
+}
+
+static void QuantizeLog(const float* input, size_t count, float logMin, float scale, unsigned int bits, void* output)
+{
+    const __m128 floor = _mm_set1_ps(std::exp2(logMin));
+    const __m128 minimum = _mm_set1_ps(logMin);
+    const __m128 factor = _mm_set1_ps(scale);
+    const __m128 maxCode = _mm_set1_ps((float)((1u << bits) - 1));
+
+    // The floor goes second so a NaN input picks it
+    auto quantize = [&](const float* values) {
+        __m128 code = _mm_mul_ps(_mm_sub_ps(Log2(_mm_max_ps(_mm_loadu_ps(values), floor)), minimum), factor);
+        code = _mm_min_ps(_mm_max_ps(code, _mm_setzero_ps()), maxCode);
+        return _mm_cvttps_epi32(_mm_add_ps(code, _mm_set1_ps(0.5f)));
+    };
+
+    size_t i = 0;
+    for(; i + 8 <= count; i += 8)
+    {
+        __m128i codes = Pack16(quantize(input + i), quantize(input + i + 4));
+
+        if(bits == 8)
+            _mm_storel_epi64(reinterpret_cast<__m128i*>(static_cast<uint8_t*>(output) + i), _mm_packus_epi16(codes, codes));
+        else
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(static_cast<uint16_t*>(output) + i), codes);
+    }
+
+    scalarKernels.QuantizeLog(input + i, count - i, logMin, scale, bits, static_cast<uint8_t*>(output) + i * (bits / 8));
+}
+
+extern const SimdKernels sse2Kernels = {
+    SimdLevel::SSE2, "SSE2",
+    &Butterflies,
+    &SparseMultiply,
+    &ConvertPcm,
+    &Statistics,
+    &FloatToHalf,
+    &QuantizeLog
+};
\ No newline at end of file
@@ -0,0 +1,218 @@
+#include "Simd.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+static void Butterflies(float* data, size_t N, size_t half, const float* twiddles)
+{
+    size_t span = half << 1;
+    for(size_t block = 0; block < N; block += span)
+    {
+        float* first = data + 2 * block;
+        float* second = first + 2 * half;
+
+        for(size_t k = 0; k < 2 * half; k += 2)
+        {
+            float wr = twiddles[k], wi = twiddles[k + 1];
+            float qr = wr * second[k] - wi * second[k + 1];
+            float qi = wr * second[k + 1] + wi * second[k];
+
+            float pr = first[k], pi = first[k + 1];
+            first[k] = pr + qr;
+            first[k + 1] = pi + qi;
+            second[k] = pr - qr;
+            second[k + 1] = pi - qi;
+        }
+    }
+}
+
+static void SparseMultiply(const SparseSpan* spans, size_t rows, const float* weights, const float* input, float* output)
+{
+    for(size_t row = 0; row < rows; row++)
+    {
+        const float* w = weights + spans[row].offset;
+        const float* x = input + spans[row].start;
+
+        float sum = 0.0f;
+        for(uint32_t i = 0; i < spans[row].length; i++)
+            sum += w[i] * x[i];
+
+        output[row] = sum;
+    }
+}
+
+// Assembles an unsigned integer from bytes, independent of host endianness
+static inline uint32_t LoadBytes(const uint8_t* ptr, size_t bytes, bool bigEndian)
+{
+    uint32_t value = 0;
+    for(size_t i = 0; i < bytes; i++)
+    {
+        uint32_t byte = ptr[bigEndian ? i : bytes - 1 - i];
+        value = (value << 8) | byte;
+    }
+
+    return value;
+}
+
+static inline float LoadSample(const uint8_t* ptr, SampleFormat format, bool bigEndian)
+{
+    uint32_t raw = LoadBytes(ptr, GetBytesPerSample(format), bigEndian);
+
+    switch(format)
+    {
+    case SampleFormat::U8:
+        return ((float)raw - 128.0f) * (1.0f / 128.0f);
+
+    case SampleFormat::S16:
+        return (float)(int16_t)raw * (1.0f / 32768.0f);
+
+    case SampleFormat::S24:
+        // Shift into the top bytes so the sign extends
+        return (float)((int32_t)(raw << 8) >> 8) * (1.0f / 8388608.0f);
+
+    case SampleFormat::S32:
+        return (float)(int32_t)raw * (1.0f / 2147483648.0f);
+
+    case SampleFormat::F32:
+    {
+        float value;
+        std::memcpy(&value, &raw, sizeof(float));
+        return value;
+    }
+    }
+
+    return 0.0f;
+}
+
+static void ConvertPcm(const uint8_t* input, size_t samples, SampleFormat format, bool bigEndian, bool downmix, float* output)
+{
+    size_t bytes = GetBytesPerSample(format);
+
+    if(downmix)
+    {
+        for(size_t i = 0; i < samples / 2; i++, input += 2 * bytes)
+        {
+            float left = LoadSample(input, format, bigEndian);
+            float right = LoadSample(input + bytes, format, bigEndian);
+            output[i] = (left + right) * 0.5f;
+        }
+    }
+    else
+    {
+        for(size_t i = 0; i < samples; i++, input += bytes)
+            output[i] = LoadSample(input, format, bigEndian);
+    }
+}
+
+static void Statistics(const float* input, size_t count, float* peak, float* sumSquares)
+{
+    float largest = 0.0f, sum = 0.0f;
+    for(size_t i = 0; i < count; i++)
+    {
+        largest = std::max(largest, std::abs(input[i]));
+        sum += input[i] * input[i];
+    }
+
+    *peak = largest;
+    *sumSquares = sum;
+}
+
+static inline uint16_t HalfFromFloat(float value)
+{
+    uint32_t x;
+    std::memcpy(&x, &value, sizeof(x));
+
+    uint32_t sign = x & 0x80000000u;
+    x ^= sign;
+
+    uint32_t result;
+    if(x >= 0x47800000u)
+    {
+        // 2^16 and above, infinity or NaN
+        result = (x > 0x7F800000u) ? 0x7E00 : 0x7C00;
+    }
+    else if(x < 0x38800000u)
+    {
+        // Below the smallest normal half. Adding 0.5 lets the FPU shift the
+        // mantissa into place and round it
+        float shifted;
+        std::memcpy(&shifted, &x, sizeof(shifted));
+        shifted += 0.5f;
+
+        std::memcpy(&result, &shifted, sizeof(result));
+        result -= 0x3F000000u;
+    }
+    else
+    {
+        // Rebias the exponent and round the mantissa to nearest even
+        uint32_t odd = (x >> 13) & 1;
+        x += ((uint32_t)(15 - 127) << 23) + 0xFFF;
+        x += odd;
+        result = x >> 13;
+    }
+
+    return (uint16_t)(result | (sign >> 16));
+}
+
+static void FloatToHalf(const float* input, size_t count, uint16_t* output)
+{
+    for(size_t i = 0; i < count; i++)
+        output[i] = HalfFromFloat(input[i]);
+}
+
+// log2 of a positive finite float. The mantissa is centered on 1, so the
+// atanh series 2/ln(2) * (t + t^3/3 + t^5/5 + t^7/7) with t = (m-1)/(m+1)
+// is accurate to about 1e-7
+static inline float Log2(float x)
+{
+    uint32_t bits;
+    std::memcpy(&bits, &x, sizeof(bits));
+
+    float exponent = (float)((int32_t)(bits >> 23) - 127);
+    bits = (bits & 0x007FFFFFu) | 0x3F800000u;
+
+    float m;
+    std::memcpy(&m, &bits, sizeof(m));
+    if(m > 1.41421356f)
+    {
+        m *= 0.5f;
+        exponent += 1.0f;
+    }
+
+    float t = (m - 1.0f) / (m + 1.0f);
+    float t2 = t * t;
+    float series = t * (2.88539008f + t2 * (0.961796694f + t2 * (0.577078016f + t2 * 0.412198583f)));
+
+    return exponent + series;
+}
+
+static void QuantizeLog(const float* input, size_t count, float logMin, float scale, unsigned int bits, void* output)
+{
+    float floor = std::exp2(logMin);
+    float maxCode = (float)((1u << bits) - 1);
+
+    for(size_t i = 0; i < count; i++)
+    {
+        // Written so NaN picks the floor, like the vector max does
+        float x = (input[i] > floor) ? input[i] : floor;
+        float code = (Log2(x) - logMin) * scale;
+        code = std::min(std::max(code, 0.0f), maxCode);
+
+        uint32_t rounded = (uint32_t)(code + 0.5f);
+        if(bits == 8)
+            static_cast<uint8_t*>(output)[i] = (uint8_t)rounded;
+        else
+            static_cast<uint16_t*>(output)[i] = (uint16_t)rounded;
+    }
+}
+
+extern const SimdKernels scalarKernels = {
+    SimdLevel::Scalar, "Scalar",
+    &Butterflies,
+    &SparseMultiply,
+    &ConvertPcm,
+    &Statistics,
+    &FloatToHalf,
+    &QuantizeLog
+};
\ No newline at end of file
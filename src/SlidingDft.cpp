@@ -0,0 +1,125 @@
+#include "SlidingDft.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+SlidingDft::SlidingDft(size_t N, const std::vector<size_t>& bins, WindowType window, size_t resyncInterval, const ChannelMix& mix) :
+    N(N), window(window), mix(mix), resyncInterval(std::max<size_t>(resyncInterval, 1)), plan(N)
+{
+    if(window != WindowType::Rectangular && window != WindowType::Hann)
+        throw std::runtime_error("Sliding DFT only supports rectangular and Hann windows");
+
+    for(size_t k : bins)
+        requested.push_back(std::min(k, N / 2));
+
+    std::sort(requested.begin(), requested.end());
+    requested.erase(std::unique(requested.begin(), requested.end()), requested.end());
+
+    // The Hann window needs both neighbours. Past DC and Nyquist they are
+    // mirrored, since the spectrum of a real signal is conjugate symmetric
+    for(size_t k : requested)
+    {
+        tracked.push_back(k);
+
+        if(window == WindowType::Hann)
+        {
+            tracked.push_back(k == 0 ? 1 : k - 1);
+            tracked.push_back(k == N / 2 ? N / 2 - 1 : k + 1);
+        }
+    }
+
+    std::sort(tracked.begin(), tracked.end());
+    tracked.erase(std::unique(tracked.begin(), tracked.end()), tracked.end());
+
+    real.resize(tracked.size(), 0.0f);
+    imag.resize(tracked.size(), 0.0f);
+    for(size_t k : tracked)
+    {
+        double phi = 2.0 * M_PI * (double)k / (double)N;
+        rotationReal.push_back((float)std::cos(phi));
+        rotationImag.push_back((float)std::sin(phi));
+    }
+
+    history.resize(N, 0.0f);
+    input.resize(N);
+    spectrum.resize(plan.GetBins());
+    magnitudes.resize(plan.GetBins(), 0.0f);
+}
+
+void SlidingDft::Push(const float* frames, size_t count)
+{
+    size_t bins = tracked.size();
+    float* re = real.data();
+    float* im = imag.data();
+    const float* cr = rotationReal.data();
+    const float* ci = rotationImag.data();
+
+    for(size_t n = 0; n < count; n++)
+    {
+        // S_k <- e^(2*pi*i*k/N) * (S_k + x[n] - x[n - N])
+        float sample = mix.Apply(frames + n * mix.channels);
+        float delta = sample - history[writePos];
+        history[writePos] = sample;
+        writePos = (writePos + 1) % N;
+
+        for(size_t b = 0; b < bins; b++)
+        {
+            float r = re[b] + delta;
+            float i = im[b];
+            re[b] = r * cr[b] - i * ci[b];
+            im[b] = r * ci[b] + i * cr[b];
+        }
+
+        if(++sinceResync >= resyncInterval)
+            Resync();
+    }
+}
+
+const float* SlidingDft::Analyze()
+{
+    auto find = [this](size_t k) {
+        return std::lower_bound(tracked.begin(), tracked.end(), k) - tracked.begin();
+    };
+
+    for(size_t k : requested)
+    {
+        size_t b = find(k);
+        float re = real[b], im = imag[b];
+        float scale = 2.0f / (float)N;
+
+        if(window == WindowType::Hann)
+        {
+            // Multiplying with the Hann window is a convolution with (-1/4, 1/2, -1/4)
+            size_t below = find(k == 0 ? 1 : k - 1);
+            size_t above = find(k == N / 2 ? N / 2 - 1 : k + 1);
+            float belowIm = (k == 0) ? -imag[below] : imag[below];
+            float aboveIm = (k == N / 2) ? -imag[above] : imag[above];
+
+            re = 0.5f * re - 0.25f * (real[below] + real[above]);
+            im = 0.5f * im - 0.25f * (belowIm + aboveIm);
+            scale *= 2.0f;
+        }
+
+        magnitudes[k] = scale * std::sqrt(re * re + im * im);
+    }
+
+    return magnitudes.data();
+}
+
+void SlidingDft::Resync()
+{
+    // The recursion's state equals the DFT of the history, oldest sample first
+    size_t tail = N - writePos;
+    std::copy(history.begin() + writePos, history.end(), input.begin());
+    std::copy(history.begin(), history.begin() + writePos, input.begin() + tail);
+
+    plan.Transform(input.data(), spectrum.data());
+    for(size_t b = 0; b < tracked.size(); b++)
+    {
+        real[b] = spectrum[tracked[b]].real();
+        imag[b] = spectrum[tracked[b]].imag();
+    }
+
+    sinceResync = 0;
+}
\ No newline at end of file
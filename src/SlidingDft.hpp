@@ -0,0 +1,55 @@
+#pragma once
+
+#include <complex>
+#include <vector>
+
+#include "FftPlan.hpp"
+#include "Window.hpp"
+#include "ChannelMix.hpp"
+
+// Sliding DFT over the last N samples. Every new sample updates only the
+// tracked bins in O(bins), which beats a full FFT per column for very small
+// hops. The recursion accumulates rounding error, so the state is recomputed
+// from the sample history with an FFT every resyncInterval samples.
+class SlidingDft
+{
+public:
+    // Only rectangular and Hann windows are supported, the Hann window is
+    // applied in the frequency domain using the two neighbouring bins
+    SlidingDft(size_t N, const std::vector<size_t>& bins, WindowType window, size_t resyncInterval, const ChannelMix& mix = ChannelMix());
+
+    // Pushes count interleaved frames, reduced to one signal by the channel mix
+    void Push(const float* frames, size_t count);
+
+    // Returns N/2 + 1 magnitudes, only the requested bins are valid
+    const float* Analyze();
+
+    inline size_t GetSize() const { return N; }
+    inline size_t GetBins() const { return N / 2 + 1; }
+
+private:
+    void Resync();
+
+private:
+    size_t N;
+    WindowType window;
+    ChannelMix mix;
+    size_t resyncInterval;
+    size_t sinceResync = 0;
+
+    std::vector<size_t> requested;
+    std::vector<size_t> tracked;
+
+    // State and rotation factors of the tracked bins, split up so the
+    // per-sample update vectorizes
+    std::vector<float> real, imag;
+    std::vector<float> rotationReal, rotationImag;
+
+    std::vector<float> history;
+    size_t writePos = 0;
+
+    RealFftPlan plan;
+    std::vector<float> input;
+    std::vector<std::complex<float>> spectrum;
+    std::vector<float> magnitudes;
+};
\ No newline at end of file
@@ -1,114 +1,262 @@
 #include "Spectrogram.hpp"
 
-#include <complex>
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <utility>
 
-#define POW_OF_TWO(x) ((x) && !((x) & ((x) - 1)))
+Spectrogram::Spectrogram(
+    lol::ObjectManager& manager, 
+    const glm::vec2& size, 
+    const glm::uvec2& subdivision,
+    AudioFile audio,
+    const SpectrogramSettings& settings
+) :
+    Topology(manager, size, subdivision, settings.storage), audio(std::move(audio)), settings(settings)
+{
+    // Normalized by Setup(), unless the columns come from the cache
+    channels = std::max(this->audio.GetChannels(), 1u);
+    Setup((float)this->audio.GetAudioSpec().freq);
+}
 
-std::vector<std::complex<float>> radix2dit(
-    const std::vector<float> samples, 
-    size_t offset,
-    size_t N, 
-    size_t s
-);
+Spectrogram::Spectrogram(
+    lol::ObjectManager& manager, 
+    const glm::vec2& size, 
+    const glm::uvec2& subdivision,
+    CaptureSource& capture,
+    const SpectrogramSettings& settings
+) :
+    Topology(manager, size, subdivision, settings.storage), audio(std::vector<float>(), capture.GetAudioSpec()), capture(&capture), settings(settings)
+{
+    this->settings.precompute = false;
+
+    channels = std::max(capture.GetChannels(), 1u);
+    Setup((float)capture.GetAudioSpec().freq);
+
+    if(settings.automaticGain)
+        gainControl = std::make_unique<GainControl>(settings.gainControl, sampleRate, (unsigned int)channels);
+}
 
 Spectrogram::Spectrogram(
     lol::ObjectManager& manager, 
     const glm::vec2& size, 
     const glm::uvec2& subdivision,
-    const AudioFile& audio
+    StreamingSource& stream,
+    const SpectrogramSettings& settings
 ) :
-    Topology(manager, size, subdivision), audio(audio)
+    Topology(manager, size, subdivision, settings.storage), audio(std::vector<float>(), SDL_AudioSpec()), stream(&stream), settings(settings)
 {
-    this->audio.Normalize();
+    this->settings.precompute = false;
 
-    range = glm::vec2(0.0f, 0.0005f);
-    MakeTexture();
-} 
+    channels = std::max(stream.GetChannels(), 1u);
+    Setup((float)stream.GetSampleRate());
 
-void Spectrogram::Update()
+    if(settings.automaticGain)
+        gainControl = std::make_unique<GainControl>(settings.gainControl, sampleRate, (unsigned int)channels);
+}
+
+void Spectrogram::Setup(float sampleRate)
 {
-    // Load samples
-    unsigned int sampleNumber = audio.GetAudioSpec().freq / 60;
-    std::vector<float> samples(audio.begin() + currentStrip * sampleNumber, audio.begin() + (currentStrip + 1) * sampleNumber);
-    size_t N = samples.size();
+    this->sampleRate = sampleRate;
+    glm::uvec2 subdivision = GetSize();
+    std::vector<ChannelMix> mixes = MakeChannelMixes(settings.channelView, channels);
+
+    float maxFrequency = (settings.maxFrequency > 0.0f) ? settings.maxFrequency : sampleRate / 2.0f;
 
-    // Zeropad the signal
-    while(!POW_OF_TWO(N))
+    // The sliding DFT has no zeropadding, its resolution is set by the frame size
+    size_t transformSize;
+    float analysisRate = sampleRate;
+    if(settings.mode == AnalysisMode::SlidingDft)
     {
-        samples.push_back(0.0f);
-        N++;
+        transformSize = settings.stft.frameSize;
     }
+    else
+    {
+        if(settings.decimate)
+            settings.stft.decimation = ChooseDecimation(settings.stft, sampleRate, maxFrequency);
 
-    N = samples.size() << 3;
-    samples.insert(samples.end(), N - samples.size(), 0.0f);
+        for(const ChannelMix& mix : mixes)
+            stfts.push_back(std::make_unique<Stft>(settings.stft, mix));
 
-    // Perform Fourier transformation on the next samples
-    std::vector<std::complex<float>> spectrum = radix2dit(samples, 0, N, 1);
-    float freqRes = (float)audio.GetAudioSpec().freq / (float)N;
-	float nyquistLimit = (float)audio.GetAudioSpec().freq / 2.0f;
+        transformSize = stfts[0]->GetTransformSize();
+        analysisRate = sampleRate / (float)settings.stft.decimation;
+    }
 
-	std::vector<std::pair<float, float>> output;
-	float freq = 50.0f;
-	float maxFreq = nyquistLimit;
+    size_t bandRows = subdivision.y / mixes.size();
+    binning = BinningKernel(settings.scale, transformSize, analysisRate, bandRows, settings.minFrequency, maxFrequency);
 
-	for (int k = freq / freqRes; freq < nyquistLimit && freq < maxFreq; k++)    // ??? wtf is going on here?
-	{
-		output.push_back(std::make_pair(freq, 2.0f * std::abs(spectrum[k]) / (float)N));
+    // The sliding DFT only needs to keep the bins the image rows read from
+    if(settings.mode == AnalysisMode::SlidingDft)
+    {
+        for(const ChannelMix& mix : mixes)
+            sdfts.push_back(std::make_unique<SlidingDft>(transformSize, binning.GetUsedBins(), settings.stft.window, settings.resyncInterval, mix));
+    }
 
-		freq += freqRes;
-	}
+    if(settings.precompute && !stfts.empty())
+    {
+        Precompute(mixes, maxFrequency);
+    }
+    else
+    {
+        // The gain is applied by the filterbank, so the samples can still be
+        // analyzed where they are
+        audio.Normalize();
+        binning.Scale(audio.GetGain());
 
-    float* pixels = GetTopology();
-    glm::uvec2 dims = image.GetDimensions();
+        hopFrames.resize(settings.stft.hopSize * channels);
+    }
 
-    glm::vec2 arrayDomain(0.0f, N);
-    glm::vec2 imageDomain(0.0f, dims.y);
+    // The log formats cover 96 dB below the top of the color range and 24 dB
+    // above it
+    range = glm::vec2(0.0f, 0.005f);
+    SetLogRange(std::log2(range.y) - 16.0f, std::log2(range.y) + 4.0f);
+    MakeTexture();
+} 
 
-    unsigned int imageStrip = currentStrip % dims.x;
-    for(unsigned int y = 0; y < dims.y; y++)
+void Spectrogram::Precompute(const std::vector<ChannelMix>& mixes, float maxFrequency)
+{
+    // The key covers the samples and everything the columns depend on, so
+    // a hit can be used as is
+    bool cacheable = !settings.cacheDirectory.empty();
+    SpectrogramCacheHeader header;
+    if(cacheable)
     {
-        std::complex<float> sample = output[Map(imageDomain, arrayDomain, y)].second;
-        float magnitude = std::abs(sample);
+        header = SpectrogramCache::MakeHeader(
+            audio.GetContentHash(), sampleRate, (unsigned int)channels,
+            settings.stft, settings.channelView,
+            settings.scale, settings.minFrequency, maxFrequency,
+            mixes.size() * binning.GetRows()
+        );
 
-        pixels[y * dims.x + imageStrip] = magnitude;
+        cached = SpectrogramCache::Open(settings.cacheDirectory, header);
+        if(cached)
+            return;
     }
 
-    MakeTexture();
+    audio.Normalize();
+    binning.Scale(audio.GetGain());
 
-    currentStrip++;
-    offset += 1.0f / (float)dims.x;
+    ThreadPool workers;
+    const AudioFile& source = audio;
+    precomputed = std::make_unique<OfflineSpectrogram>(
+        [&source](uint64_t first, size_t count, float* buffer) { return source.GetFrames(first, count, buffer); },
+        source.GetFrameCount(),
+        mixes, settings.stft, binning, workers
+    );
+
+    if(cacheable && !SpectrogramCache::Store(settings.cacheDirectory, header, *precomputed))
+        std::cerr << "Failed to cache the spectrogram in \"" << settings.cacheDirectory << "\"" << std::endl;
 }
 
-std::vector<std::complex<float>> radix2dit(
-    const std::vector<float> samples, 
-    size_t offset,
-    size_t N, 
-    size_t s
-)
+size_t Spectrogram::Update(size_t columns)
 {
-    std::vector<std::complex<float>> output(N);
+    unsigned int first = currentStrip;
+    size_t added = 0;
+    while(added < columns && AddColumn())
+        added++;
 
-    if(N == 1)
+    // Only the new columns go up, however many there are
+    UploadColumns(first, (unsigned int)std::min<size_t>(added, GetSize().x));
+
+    return added;
+}
+
+bool Spectrogram::AddColumn()
+{
+    // Columns are contiguous in the history, so every band is binned straight
+    // into its rows and stored columns are a plain copy
+    float* target = GetColumn(currentStrip);
+
+    // Every column is one hop further into the input, skipped ones included
+    size_t hop = settings.stft.hopSize;
+    size_t stored = (size_t)(position / hop);
+
+    if(cached)
     {
-        output[0] = samples[offset];
+        if(stored >= cached->GetColumns())
+            return false;
+
+        const float* values = cached->GetColumn(stored);
+        std::copy(values, values + cached->GetRows(), target);
+    }
+    else if(precomputed)
+    {
+        if(stored >= precomputed->GetColumns())
+            return false;
+
+        const float* values = precomputed->GetColumn(stored);
+        std::copy(values, values + precomputed->GetRows(), target);
     }
     else
     {
-        size_t halfN = N >> 1;
-        std::vector<std::complex<float>> first = radix2dit(samples, offset, halfN, 2 * s);
-        std::vector<std::complex<float>> second = radix2dit(samples, offset + s, halfN, 2 * s);
+        const float* frames = hopFrames.data();
+        if(capture)
+        {
+            if(!capture->Read(hopFrames.data(), hop))
+                return false;
+        }
+        else if(stream)
+        {
+            if(stream->Read(hopFrames.data(), hop) < hop)
+                return false;
+        }
+        else
+        {
+            if(position + hop > audio.GetFrameCount())
+                return false;
+
+            // Float samples are analyzed where they are, anything else is
+            // converted into the hop buffer first
+            frames = audio.GetFrames(position, hop, hopFrames.data());
+        }
+
+        if(gainControl)
+            gainControl->Process(hopFrames.data(), hop);
+
+        // There are three mixes at most. Handing them to other threads would
+        // take a lock per column, so they are analyzed right here and draining
+        // the capture stays lock-free
+        size_t bands = std::max(stfts.size(), sdfts.size());
+        for(size_t band = 0; band < bands; band++)
+        {
+            const float* spectrum;
+            if(!sdfts.empty())
+            {
+                sdfts[band]->Push(frames, hop);
+                spectrum = sdfts[band]->Analyze();
+            }
+            else
+            {
+                stfts[band]->Push(frames, hop);
+                spectrum = stfts[band]->Analyze();
+            }
+
+            binning.Apply(spectrum, target + band * binning.GetRows());
+        }
+    }
 
-        float coeff = -M_PI / (float)halfN;
+    position += hop;
+    currentStrip++;
+    offset += 1.0f / (float)GetSize().x;
 
-		for (int k = 0; k < halfN; k++)
-		{
-			std::complex<float> p = first[k];
-			std::complex<float> q = std::exp(coeff * (float)k) * second[k];
+    return true;
+}
 
-			output[k] = p + q;
-			output[halfN + k] = p - q;
-		}
+void Spectrogram::Skip(size_t columns)
+{
+    size_t hop = settings.stft.hopSize;
+    if(capture)
+    {
+        // The clock never runs ahead of what was captured, but frames the
+        // ring dropped are gone already
+        columns = std::min(columns, capture->GetAvailable() / hop);
+        for(size_t i = 0; i < columns; i++)
+            capture->Read(hopFrames.data(), hop);
+    }
+    else if(stream)
+    {
+        stream->Seek(stream->GetPosition() + (uint64_t)columns * hop);
     }
 
-    return output;
+    position += (uint64_t)columns * hop;
 }
\ No newline at end of file
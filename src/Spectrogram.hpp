@@ -1,21 +1,87 @@
 #pragma once
 
+#include <memory>
+
 #include "Topology.hpp"
 #include "AudioFile.hpp"
+#include "CaptureSource.hpp"
+#include "StreamingSource.hpp"
+#include "Stft.hpp"
+#include "SlidingDft.hpp"
+#include "BinningKernel.hpp"
+#include "OfflineSpectrogram.hpp"
+#include "SpectrogramCache.hpp"
+#include "SpectrogramSettings.hpp"
 
 class Spectrogram : public Topology
 {
 public:
+    // Shares the samples of audio, they are never copied
+    Spectrogram(
+        lol::ObjectManager& manager, 
+        const glm::vec2& size, 
+        const glm::uvec2& subdivision,
+        AudioFile audio,
+        const SpectrogramSettings& settings = SpectrogramSettings()
+    );
+
+    // Live input. The capture source has to outlive the spectrogram, and
+    // precompute is ignored
+    Spectrogram(
+        lol::ObjectManager& manager, 
+        const glm::vec2& size, 
+        const glm::uvec2& subdivision,
+        CaptureSource& capture,
+        const SpectrogramSettings& settings = SpectrogramSettings()
+    );
+
+    // Reads the file in chunks instead, for recordings too long to keep around.
+    // The source has to outlive the spectrogram, and precompute is ignored
     Spectrogram(
         lol::ObjectManager& manager, 
         const glm::vec2& size, 
         const glm::uvec2& subdivision,
-        const AudioFile& audio
+        StreamingSource& stream,
+        const SpectrogramSettings& settings = SpectrogramSettings()
     );
 
-    void Update();
+    // Adds up to columns new columns and uploads them together. Returns how
+    // many were added, fewer once the input runs dry
+    size_t Update(size_t columns = 1);
+
+    // Skips the input of that many columns without analyzing it, e.g. when
+    // the image fell too far behind its clock. The analyzers simply continue
+    // with the frames after the gap
+    void Skip(size_t columns);
+
+    // Frames each column advances by
+    inline size_t GetHopSize() const { return settings.stft.hopSize; }
+    inline float GetSampleRate() const { return sampleRate; }
+
+private:
+    void Setup(float sampleRate);
+    void Precompute(const std::vector<ChannelMix>& mixes, float maxFrequency);
+    bool AddColumn();
 
 private:
     AudioFile audio;
+    CaptureSource* capture = nullptr;
+    StreamingSource* stream = nullptr;
     unsigned int currentStrip = 0;
+
+    SpectrogramSettings settings;
+    float sampleRate;
+    size_t channels;
+    uint64_t position = 0;
+    std::vector<float> hopFrames;
+    std::unique_ptr<GainControl> gainControl;
+
+    // One analyzer per channel mix. Only precomputing spreads them across
+    // threads, streamed columns are analyzed on the render thread
+    std::vector<std::unique_ptr<Stft>> stfts;
+    std::vector<std::unique_ptr<SlidingDft>> sdfts;
+    std::unique_ptr<OfflineSpectrogram> precomputed;
+    std::unique_ptr<SpectrogramCache> cached;
+
+    BinningKernel binning;
 };
\ No newline at end of file
@@ -0,0 +1,156 @@
+#include "SpectrogramCache.hpp"
+
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+
+#include "Hash.hpp"
+
+// Bump whenever the file layout or the analysis changes what a column holds
+static constexpr uint32_t CACHE_VERSION = 1;
+static constexpr uint32_t BYTE_ORDER_MARK = 0x01020304;
+static const char CACHE_MAGIC[8] = { 'V', 'I', 'S', 'S', 'P', 'E', 'C', '\0' };
+
+SpectrogramCacheHeader SpectrogramCache::MakeHeader(
+    uint64_t contentHash, float sampleRate, unsigned int channels,
+    const StftSettings& stft, ChannelView channelView,
+    FrequencyScale scale, float minFrequency, float maxFrequency,
+    size_t rows
+)
+{
+    // Zeroed first, so the reserved bytes hash and compare the same every time
+    SpectrogramCacheHeader header;
+    std::memset(&header, 0, sizeof(header));
+
+    std::memcpy(header.magic, CACHE_MAGIC, sizeof(header.magic));
+    header.version = CACHE_VERSION;
+    header.byteOrder = BYTE_ORDER_MARK;
+
+    header.contentHash = contentHash;
+    header.rows = (uint32_t)rows;
+    header.sampleRate = sampleRate;
+    header.channels = channels;
+    header.channelView = (uint32_t)channelView;
+
+    header.frameSize = (uint32_t)stft.frameSize;
+    header.hopSize = (uint32_t)stft.hopSize;
+    header.fftSize = (uint32_t)stft.fftSize;
+    header.decimation = (uint32_t)stft.decimation;
+    header.window = (uint32_t)stft.window;
+    header.kaiserBeta = stft.kaiserBeta;
+
+    header.scale = (uint32_t)scale;
+    header.minFrequency = minFrequency;
+    header.maxFrequency = maxFrequency;
+
+    return header;
+}
+
+std::string SpectrogramCache::GetPath(const std::string& directory, const SpectrogramCacheHeader& header)
+{
+    // The column count follows from the samples, it isn't part of the key
+    SpectrogramCacheHeader key = header;
+    key.columns = 0;
+
+    char name[32];
+    std::snprintf(name, sizeof(name), "%016llx.spec", (unsigned long long)HashBytes(&key, sizeof(key)));
+
+    return (std::filesystem::path(directory) / name).string();
+}
+
+SpectrogramCache::SpectrogramCache(const std::string& path) :
+    file(path)
+{
+}
+
+std::unique_ptr<SpectrogramCache> SpectrogramCache::Open(const std::string& directory, const SpectrogramCacheHeader& header)
+{
+    std::string path = GetPath(directory, header);
+
+    std::error_code error;
+    if(!std::filesystem::is_regular_file(path, error))
+        return nullptr;
+
+    std::unique_ptr<SpectrogramCache> cache;
+    try
+    {
+        cache = std::unique_ptr<SpectrogramCache>(new SpectrogramCache(path));
+    }
+    catch(const std::runtime_error&)
+    {
+        return nullptr;
+    }
+
+    const MappedFile& file = cache->file;
+    if(file.GetSize() < sizeof(SpectrogramCacheHeader))
+        return nullptr;
+
+    SpectrogramCacheHeader stored;
+    std::memcpy(&stored, file.GetData(), sizeof(stored));
+
+    // Everything but the column count has to match, which also rules out hash
+    // collisions and files of another byte order or version
+    SpectrogramCacheHeader expected = header;
+    expected.columns = stored.columns;
+    if(std::memcmp(&stored, &expected, sizeof(stored)) != 0)
+        return nullptr;
+
+    // A truncated file, e.g. from a crash while storing, is no hit either
+    uint64_t dataSize = stored.columns * stored.rows * sizeof(float);
+    if(file.GetSize() != sizeof(SpectrogramCacheHeader) + dataSize)
+        return nullptr;
+
+    cache->columns = reinterpret_cast<const float*>(file.GetData() + sizeof(SpectrogramCacheHeader));
+    cache->count = (size_t)stored.columns;
+    cache->rows = stored.rows;
+
+    return cache;
+}
+
+bool SpectrogramCache::Store(const std::string& directory, const SpectrogramCacheHeader& header, const OfflineSpectrogram& spectrogram)
+{
+    if(spectrogram.GetRows() != header.rows)
+        return false;
+
+    std::error_code error;
+    std::filesystem::create_directories(directory, error);
+    if(error)
+        return false;
+
+    SpectrogramCacheHeader stored = header;
+    stored.columns = spectrogram.GetColumns();
+
+    // Written under a temporary name and renamed once complete, so a reader
+    // never maps a half written file
+    std::string path = GetPath(directory, header);
+    std::string temporary = path + ".tmp";
+    {
+        std::ofstream output(temporary, std::ios::binary | std::ios::trunc);
+        output.write(reinterpret_cast<const char*>(&stored), sizeof(stored));
+        if(spectrogram.GetColumns() > 0)
+        {
+            output.write(
+                reinterpret_cast<const char*>(spectrogram.GetColumn(0)),
+                (std::streamsize)(spectrogram.GetColumns() * spectrogram.GetRows() * sizeof(float))
+            );
+        }
+
+        if(!output.good())
+        {
+            output.close();
+            std::filesystem::remove(temporary, error);
+            return false;
+        }
+    }
+
+    std::filesystem::rename(temporary, path, error);
+    if(error)
+    {
+        std::filesystem::remove(temporary, error);
+        return false;
+    }
+
+    return true;
+}
@@ -0,0 +1,84 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <string>
+
+#include "MappedFile.hpp"
+#include "Stft.hpp"
+#include "BinningKernel.hpp"
+#include "ChannelMix.hpp"
+#include "OfflineSpectrogram.hpp"
+
+// Fixed size header of a cache file, followed by columns * rows floats stored
+// column by column in host byte order. Every field is written out explicitly,
+// so the struct has no padding and can be hashed and compared bytewise.
+struct SpectrogramCacheHeader
+{
+    char magic[8];
+    uint32_t version;
+    uint32_t byteOrder;         // 0x01020304 as written by the host
+
+    uint64_t contentHash;       // Of the samples, see AudioFile::GetContentHash()
+    uint64_t columns;           // 0 until the columns are stored
+
+    uint32_t rows;
+    float sampleRate;
+    uint32_t channels;
+    uint32_t channelView;
+
+    uint32_t frameSize;
+    uint32_t hopSize;
+    uint32_t fftSize;
+    uint32_t decimation;
+    uint32_t window;
+    float kaiserBeta;
+
+    uint32_t scale;
+    float minFrequency;
+    float maxFrequency;
+
+    uint8_t reserved[44];
+};
+
+static_assert(sizeof(SpectrogramCacheHeader) == 128, "Cache header must not contain padding");
+
+// Precomputed spectrograms kept on disk between runs. A file is named after
+// the hash of its header, i.e. of the samples and every analysis parameter
+// the columns depend on, so changing any of them simply misses the cache.
+// Opening a hit only maps the file, the columns are paged in as they scroll
+// by. Caching is best effort, a missing, stale or unwritable cache only
+// means the columns are computed again.
+class SpectrogramCache
+{
+public:
+    static SpectrogramCacheHeader MakeHeader(
+        uint64_t contentHash, float sampleRate, unsigned int channels,
+        const StftSettings& stft, ChannelView channelView,
+        FrequencyScale scale, float minFrequency, float maxFrequency,
+        size_t rows
+    );
+
+    // Name of the file the columns for header are stored in
+    static std::string GetPath(const std::string& directory, const SpectrogramCacheHeader& header);
+
+    // Maps the cached columns, nullptr if there are none for this header
+    static std::unique_ptr<SpectrogramCache> Open(const std::string& directory, const SpectrogramCacheHeader& header);
+
+    // Writes the columns next to the others in directory, creating it if
+    // needed. Returns false if that failed
+    static bool Store(const std::string& directory, const SpectrogramCacheHeader& header, const OfflineSpectrogram& spectrogram);
+
+    inline const float* GetColumn(size_t column) const { return columns + column * rows; }
+    inline size_t GetColumns() const { return count; }
+    inline size_t GetRows() const { return rows; }
+
+private:
+    SpectrogramCache(const std::string& path);
+
+private:
+    MappedFile file;
+    const float* columns = nullptr;
+    size_t count = 0;
+    size_t rows = 0;
+};
@@ -0,0 +1,55 @@
+#pragma once
+
+#include <string>
+
+#include "Stft.hpp"
+#include "ChannelMix.hpp"
+#include "BinningKernel.hpp"
+#include "GainControl.hpp"
+#include "TexelFormat.hpp"
+
+enum class AnalysisMode
+{
+    Fft,            // One FFT per hop
+    SlidingDft      // Per-sample update of the displayed bins, for hops of a few samples
+};
+
+struct SpectrogramSettings
+{
+    AnalysisMode mode = AnalysisMode::Fft;
+    StftSettings stft;          // The sliding DFT uses frameSize, hopSize and a rectangular or Hann window
+
+    // Samples between two recalculations of the sliding DFT state
+    size_t resyncInterval = 4096;
+
+    // Frequency axis of the image rows, a maxFrequency of 0 means Nyquist
+    FrequencyScale scale = FrequencyScale::Logarithmic;
+    float minFrequency = 50.0f;
+    float maxFrequency = 0.0f;
+
+    // Which signals are derived from multichannel audio. Each one is analyzed
+    // on its own and gets an equal band of the image rows
+    ChannelView channelView = ChannelView::Mixdown;
+
+    // Decimate ahead of the FFT when maxFrequency is far enough below Nyquist.
+    // Keeps the frequency and time resolution, but each transform shrinks by
+    // the decimation factor (FFT mode only)
+    bool decimate = true;
+
+    // Live and streamed input can't be normalized up front, so an automatic
+    // gain control levels it instead. Files are always normalized
+    bool automaticGain = true;
+    GainControlSettings gainControl;
+
+    // Compute every column of the file on all cores up front (FFT mode only),
+    // Update() then just streams the finished columns
+    bool precompute = false;
+
+    // Where precomputed columns are kept between runs, empty disables the
+    // cache. A hit skips the analysis and the normalization pass entirely
+    std::string cacheDirectory;
+
+    // How the history is kept on the GPU. The log formats cover 96 dB below
+    // the top of the color range up to 24 dB above it
+    TextureStorage storage = TextureStorage::Float;
+};
@@ -0,0 +1,165 @@
+#include "Stft.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+// The sizes have to stay multiples of the factor, and a frame must not shrink
+// to just a few samples
+size_t ChooseDecimation(const StftSettings& settings, float sampleRate, float maxFrequency)
+{
+    size_t decimation = 1;
+    while(true)
+    {
+        size_t next = decimation * 2;
+        bool fits = (maxFrequency <= 0.35f * sampleRate / (float)next);
+        bool divides = (settings.frameSize % next == 0 && settings.hopSize % next == 0 && settings.fftSize % next == 0);
+
+        if(!fits || !divides || settings.frameSize / next < 64)
+            return decimation;
+
+        decimation = next;
+    }
+}
+
+static StftSettings Validate(StftSettings settings)
+{
+    if(settings.frameSize == 0 || settings.hopSize == 0 || settings.decimation == 0)
+        throw std::runtime_error("STFT frame and hop size and decimation must be non-zero");
+
+    if(settings.fftSize == 0)
+    {
+        settings.fftSize = 2;
+        while(settings.fftSize < settings.frameSize)
+            settings.fftSize <<= 1;
+    }
+
+    if(settings.fftSize < settings.frameSize)
+        throw std::runtime_error("STFT transform size must not be smaller than the frame size");
+
+    size_t decimation = settings.decimation;
+    if(settings.frameSize % decimation != 0 || settings.hopSize % decimation != 0 || settings.fftSize % decimation != 0)
+        throw std::runtime_error("STFT sizes must be multiples of the decimation factor");
+
+    return settings;
+}
+
+Stft::Stft(const StftSettings& settings, const ChannelMix& mix) :
+    settings(Validate(settings)), mix(mix), plan(this->settings.fftSize / this->settings.decimation)
+{
+    // Everything after the decimator runs at the lower rate
+    size_t decimation = this->settings.decimation;
+    size_t frameSize = this->settings.frameSize / decimation;
+    window = MakeWindow(this->settings.window, frameSize, this->settings.kaiserBeta);
+
+    // Scale so that a full-scale sine peaks at 1 regardless of window and frame size
+    float windowSum = 0.0f;
+    for(float w : window)
+        windowSum += w;
+
+    scale = 2.0f / windowSum;
+
+    if(decimation > 1)
+    {
+        decimator = std::make_unique<Decimator>(decimation);
+        mixed.resize(std::max(this->settings.hopSize, GetInputSpan()));
+        decimated.resize(mixed.size() / decimation + 1);
+    }
+
+    history.resize(frameSize, 0.0f);
+    input.resize(plan.GetSize(), 0.0f);
+    spectrum.resize(plan.GetBins());
+    magnitudes.resize(plan.GetBins());
+}
+
+size_t Stft::Push(const float* frames, size_t count)
+{
+    count = std::min(count, settings.hopSize - pending);
+
+    // Mix and decimate in one go, only the decimated samples enter the ring
+    const float* samples = nullptr;
+    size_t produced = count;
+    if(decimator)
+    {
+        for(size_t i = 0; i < count; i++)
+            mixed[i] = mix.Apply(frames + i * mix.channels);
+
+        produced = decimator->Process(mixed.data(), count, decimated.data());
+        samples = decimated.data();
+    }
+
+    size_t consumed = 0;
+    while(consumed < produced)
+    {
+        size_t chunk = std::min(produced - consumed, history.size() - writePos);
+        if(samples)
+        {
+            std::copy(samples + consumed, samples + consumed + chunk, history.begin() + writePos);
+        }
+        else
+        {
+            for(size_t i = 0; i < chunk; i++)
+                history[writePos + i] = mix.Apply(frames + (consumed + i) * mix.channels);
+        }
+
+        consumed += chunk;
+        writePos = (writePos + chunk) % history.size();
+    }
+
+    pending += count;
+    return count;
+}
+
+const float* Stft::Analyze()
+{
+    // The oldest sample sits at the write position, window while unwrapping the ring
+    size_t tail = history.size() - writePos;
+    for(size_t i = 0; i < tail; i++)
+        input[i] = history[writePos + i] * window[i];
+
+    for(size_t i = 0; i < writePos; i++)
+        input[tail + i] = history[i] * window[tail + i];
+
+    Transform(magnitudes.data());
+    pending = 0;
+
+    return magnitudes.data();
+}
+
+void Stft::AnalyzeFrame(const float* frames, float* magnitudes)
+{
+    if(decimator)
+    {
+        size_t span = GetInputSpan();
+        for(size_t i = 0; i < span; i++)
+            mixed[i] = mix.Apply(frames + i * mix.channels);
+
+        decimator->ProcessSpan(mixed.data(), window.size(), decimated.data());
+        for(size_t i = 0; i < window.size(); i++)
+            input[i] = decimated[i] * window[i];
+    }
+    else
+    {
+        for(size_t i = 0; i < settings.frameSize; i++)
+            input[i] = mix.Apply(frames + i * mix.channels) * window[i];
+    }
+
+    Transform(magnitudes);
+}
+
+size_t Stft::GetInputSpan() const
+{
+    return decimator ? decimator->GetSpan(window.size()) : settings.frameSize;
+}
+
+void Stft::Transform(float* magnitudes)
+{
+    // Everything past frameSize stays zero
+    plan.Transform(input.data(), spectrum.data());
+
+    for(size_t k = 0; k < spectrum.size(); k++)
+    {
+        float re = spectrum[k].real(), im = spectrum[k].imag();
+        magnitudes[k] = scale * std::sqrt(re * re + im * im);
+    }
+}
\ No newline at end of file
@@ -0,0 +1,78 @@
+#pragma once
+
+#include <complex>
+#include <memory>
+#include <vector>
+
+#include "FftPlan.hpp"
+#include "Window.hpp"
+#include "ChannelMix.hpp"
+#include "Decimator.hpp"
+
+struct StftSettings
+{
+    size_t frameSize = 2048;
+    size_t hopSize = 512;
+    size_t fftSize = 8192;      // Zeropadded transform size, 0 picks the next power of two of frameSize
+    WindowType window = WindowType::Hann;
+    float kaiserBeta = 8.6f;
+
+    // Integer factor the signal is decimated by ahead of the transform. The
+    // sizes above stay in input frames and must be multiples of it, the
+    // transform itself shrinks by this factor
+    size_t decimation = 1;
+};
+
+// Largest power of two the signal can be decimated by while maxFrequency
+// stays inside the passband of the decimation filter and the sizes of
+// settings stay multiples of it
+size_t ChooseDecimation(const StftSettings& settings, float sampleRate, float maxFrequency);
+
+// Streaming short-time Fourier transform. Keeps the last frameSize samples in a
+// ring buffer, every hopSize new samples yield one magnitude spectrum. Input
+// is interleaved audio that is reduced to one signal by the channel mix.
+class Stft
+{
+public:
+    Stft(const StftSettings& settings, const ChannelMix& mix = ChannelMix());
+
+    // Buffers frames until the next hop is complete. Returns the number of frames consumed
+    size_t Push(const float* frames, size_t count);
+    inline bool IsReady() const { return pending == settings.hopSize; }
+
+    // Analyzes the current frame and starts the next hop. Returns GetBins() magnitudes
+    const float* Analyze();
+
+    // Analyzes GetInputSpan() contiguous frames, independent of the streamed state
+    void AnalyzeFrame(const float* frames, float* magnitudes);
+
+    inline const StftSettings& GetSettings() const { return settings; }
+    inline size_t GetBins() const { return plan.GetBins(); }
+
+    // Size of the transform after decimation, its bins are sampleRate / decimation / size apart
+    inline size_t GetTransformSize() const { return plan.GetSize(); }
+
+    // Frames one analysis frame depends on, including the decimation filter's history
+    size_t GetInputSpan() const;
+
+private:
+    void Transform(float* magnitudes);
+
+private:
+    StftSettings settings;
+    ChannelMix mix;
+    RealFftPlan plan;
+    std::vector<float> window;
+    float scale;
+
+    std::unique_ptr<Decimator> decimator;
+    std::vector<float> mixed, decimated;
+
+    std::vector<float> history;
+    size_t writePos = 0;
+    size_t pending = 0;
+
+    std::vector<float> input;
+    std::vector<std::complex<float>> spectrum;
+    std::vector<float> magnitudes;
+};
\ No newline at end of file
@@ -0,0 +1,148 @@
+#include "StreamingSource.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+
+#include "Simd.hpp"
+
+StreamingSource::StreamingSource(const std::string& path, size_t chunkFrames, size_t chunks) :
+    file(path, std::ios::binary), chunkFrames(std::max<size_t>(chunkFrames, 1))
+{
+    if(!file)
+        throw std::runtime_error("Failed to open \"" + path + "\"");
+
+    file.seekg(0, std::ios::end);
+    uint64_t fileSize = (uint64_t)file.tellg();
+
+    layout = ParseWav(
+        [this](uint64_t offset, uint8_t* output, size_t bytes)
+        {
+            file.clear();
+            file.seekg((std::streamoff)offset);
+            file.read(reinterpret_cast<char*>(output), (std::streamsize)bytes);
+            return (size_t)file.gcount();
+        },
+        fileSize, path
+    );
+
+    frameSize = GetBytesPerSample(layout.format) * layout.channels;
+    chunkCount = (layout.frames + this->chunkFrames - 1) / this->chunkFrames;
+
+    // Everything that is ever held in memory, allocated once
+    slots.resize(std::max<size_t>(chunks, 2));
+    for(Chunk& chunk : slots)
+        chunk.data.resize(this->chunkFrames * frameSize);
+
+    reader = std::thread(&StreamingSource::ReadAhead, this);
+}
+
+StreamingSource::~StreamingSource()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stop = true;
+    }
+
+    wanted.notify_all();
+    reader.join();
+}
+
+size_t StreamingSource::Read(float* output, size_t count)
+{
+    const SimdKernels& kernels = GetSimdKernels();
+
+    size_t done = 0;
+    while(done < count && position < layout.frames)
+    {
+        uint64_t index = position / chunkFrames;
+        size_t offset = (size_t)(position % chunkFrames);
+        Chunk& chunk = slots[index % slots.size()];
+
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+
+            // Moving the window frees the chunks behind it for the read-ahead
+            if(firstWanted != index)
+            {
+                firstWanted = index;
+                wanted.notify_one();
+            }
+
+            if(chunk.index != index || !chunk.ready)
+            {
+                stalls++;
+                loaded.wait(lock, [&]() { return chunk.index == index && chunk.ready; });
+            }
+        }
+
+        // A short read means the file shrank since it was opened
+        if(chunk.frames <= offset)
+            break;
+
+        // The chunk stays in the window until position moves past it, so it
+        // can be converted without holding the lock
+        size_t frames = std::min(count - done, chunk.frames - offset);
+        kernels.ConvertPcm(
+            chunk.data.data() + offset * frameSize, frames * layout.channels,
+            layout.format, layout.bigEndian, false, output + done * layout.channels
+        );
+        statistics.Add(output + done * layout.channels, frames * layout.channels, kernels);
+
+        done += frames;
+        position += frames;
+    }
+
+    return done;
+}
+
+void StreamingSource::Seek(uint64_t frame)
+{
+    position = std::min(frame, layout.frames);
+
+    std::lock_guard<std::mutex> lock(mutex);
+    firstWanted = position / chunkFrames;
+    wanted.notify_one();
+}
+
+void StreamingSource::ReadAhead()
+{
+    std::unique_lock<std::mutex> lock(mutex);
+    while(true)
+    {
+        // The first chunk of the window that isn't loaded yet
+        uint64_t index = firstWanted;
+        uint64_t end = std::min<uint64_t>(firstWanted + slots.size(), chunkCount);
+        while(index < end && slots[index % slots.size()].index == index)
+            index++;
+
+        if(stop)
+            return;
+
+        if(index >= end)
+        {
+            wanted.wait(lock);
+            continue;
+        }
+
+        Chunk& chunk = slots[index % slots.size()];
+        chunk.index = index;
+        chunk.ready = false;
+
+        // The consumer never touches a chunk that isn't ready, so the disk
+        // read happens without the lock
+        lock.unlock();
+
+        uint64_t first = index * chunkFrames;
+        size_t frames = (size_t)std::min<uint64_t>(chunkFrames, layout.frames - first);
+
+        file.clear();
+        file.seekg((std::streamoff)(layout.dataOffset + first * frameSize));
+        file.read(reinterpret_cast<char*>(chunk.data.data()), (std::streamsize)(frames * frameSize));
+        size_t read = (size_t)file.gcount() / frameSize;
+
+        lock.lock();
+        chunk.frames = read;
+        chunk.ready = true;
+        loaded.notify_all();
+    }
+}
\ No newline at end of file
@@ -0,0 +1,76 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstdint>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "WavFile.hpp"
+#include "GainControl.hpp"
+
+// Sequential reader for WAV files of any length. The file is read in chunks of
+// a fixed number of frames by a background thread that stays ahead of the
+// read position, and only a fixed number of chunks is ever held in memory.
+// Memory use is chunks * chunkFrames frames of raw samples, however long the
+// recording is. All offsets are 64 bit.
+class StreamingSource
+{
+public:
+    // Throws std::runtime_error if the file can't be read or isn't supported
+    StreamingSource(const std::string& path, size_t chunkFrames = 1 << 16, size_t chunks = 8);
+    ~StreamingSource();
+
+    StreamingSource(const StreamingSource& other) = delete;
+    StreamingSource& operator=(const StreamingSource& other) = delete;
+
+    // Converts the next count frames to interleaved floats. Only waits if the
+    // read-ahead fell behind. Returns the frames read, fewer at the end
+    size_t Read(float* output, size_t count);
+
+    // Moves the read position, the read-ahead restarts from there
+    void Seek(uint64_t frame);
+
+    inline uint64_t GetPosition() const { return position; }
+    inline uint64_t GetFrameCount() const { return layout.frames; }
+    inline unsigned int GetChannels() const { return layout.channels; }
+    inline unsigned int GetSampleRate() const { return layout.sampleRate; }
+
+    // Reads that had to wait for the disk
+    inline uint64_t GetStalls() const { return stalls; }
+
+    // Peak and RMS of everything read so far, gathered while converting
+    inline const SignalStatistics& GetStatistics() const { return statistics; }
+
+private:
+    void ReadAhead();
+
+private:
+    struct Chunk
+    {
+        uint64_t index = UINT64_MAX;
+        bool ready = false;
+        size_t frames = 0;
+        std::vector<uint8_t> data;
+    };
+
+    std::ifstream file;
+    WavLayout layout;
+    size_t frameSize;
+    size_t chunkFrames;
+    uint64_t chunkCount;
+
+    // Chunk k lives in slot k % slots.size() while it is in the window
+    std::vector<Chunk> slots;
+    uint64_t firstWanted = 0;
+    uint64_t position = 0;
+    uint64_t stalls = 0;
+    SignalStatistics statistics;
+
+    std::mutex mutex;
+    std::condition_variable loaded, wanted;
+    bool stop = false;
+    std::thread reader;
+};
\ No newline at end of file
@@ -0,0 +1,65 @@
+#include "TexelFormat.hpp"
+
+#include <cstring>
+#include <glad/glad.h>
+
+size_t TexelFormat::GetSize() const
+{
+    switch(storage)
+    {
+    case TextureStorage::Half:
+    case TextureStorage::Log16:
+        return 2;
+
+    case TextureStorage::Log8:
+        return 1;
+
+    default:
+        return sizeof(float);
+    }
+}
+
+unsigned int TexelFormat::GetInternalFormat() const
+{
+    switch(storage)
+    {
+    case TextureStorage::Half:  return GL_R16F;
+    case TextureStorage::Log16: return GL_R16;
+    case TextureStorage::Log8:  return GL_R8;
+    default:                    return GL_R32F;
+    }
+}
+
+unsigned int TexelFormat::GetPixelType() const
+{
+    switch(storage)
+    {
+    case TextureStorage::Half:  return GL_HALF_FLOAT;
+    case TextureStorage::Log16: return GL_UNSIGNED_SHORT;
+    case TextureStorage::Log8:  return GL_UNSIGNED_BYTE;
+    default:                    return GL_FLOAT;
+    }
+}
+
+void TexelFormat::Convert(const float* input, size_t count, void* output, const SimdKernels& kernels) const
+{
+    switch(storage)
+    {
+    case TextureStorage::Half:
+        kernels.FloatToHalf(input, count, static_cast<uint16_t*>(output));
+        break;
+
+    case TextureStorage::Log16:
+    case TextureStorage::Log8:
+    {
+        unsigned int bits = (storage == TextureStorage::Log8) ? 8 : 16;
+        float scale = (float)((1u << bits) - 1) / (logMax - logMin);
+        kernels.QuantizeLog(input, count, logMin, scale, bits, output);
+        break;
+    }
+
+    default:
+        std::memcpy(output, input, count * sizeof(float));
+        break;
+    }
+}
@@ -0,0 +1,37 @@
+#pragma once
+
+#include <cstddef>
+
+#include "Simd.hpp"
+
+// How the heightmap texture stores the history. The history itself always
+// stays float, values are converted on their way into the texture
+enum class TextureStorage
+{
+    Float,      // R32F, exact
+    Half,       // R16F, half the memory and upload bandwidth
+    Log16,      // R16, log2 of the magnitudes spread over the log range
+    Log8        // R8, a quarter of the memory, steps of range / 255 in log2
+};
+
+// Storage mode of a texture plus what it takes to decode it. The log formats
+// hold (log2(value) - logMin) / (logMax - logMin) as normalized integers,
+// everything below 2^logMin becomes zero
+struct TexelFormat
+{
+    TextureStorage storage = TextureStorage::Float;
+    float logMin = -20.0f;
+    float logMax = 0.0f;
+
+    inline bool IsLogarithmic() const { return storage == TextureStorage::Log16 || storage == TextureStorage::Log8; }
+
+    // Bytes per texel
+    size_t GetSize() const;
+
+    // Sized internal format and client pixel type for GL
+    unsigned int GetInternalFormat() const;
+    unsigned int GetPixelType() const;
+
+    // Converts count values into texels, output holds count * GetSize() bytes
+    void Convert(const float* input, size_t count, void* output, const SimdKernels& kernels = GetSimdKernels()) const;
+};
@@ -0,0 +1,66 @@
+#include "ThreadPool.hpp"
+
+#include <algorithm>
+
+ThreadPool::ThreadPool(size_t threads) :
+    next(0)
+{
+    threads = std::max<size_t>(threads, 1);
+    for(size_t i = 0; i < threads; i++)
+        this->threads.emplace_back(&ThreadPool::Work, this, i);
+}
+
+ThreadPool::~ThreadPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stop = true;
+    }
+
+    wake.notify_all();
+    for(std::thread& thread : threads)
+        thread.join();
+}
+
+void ThreadPool::ParallelFor(size_t count, size_t chunk, const Job& job)
+{
+    if(count == 0)
+        return;
+
+    std::unique_lock<std::mutex> lock(mutex);
+    this->job = &job;
+    this->count = count;
+    this->chunk = std::max<size_t>(chunk, 1);
+    next = 0;
+    busy = threads.size();
+    generation++;
+
+    wake.notify_all();
+    done.wait(lock, [this]() { return busy == 0; });
+
+    this->job = nullptr;
+}
+
+void ThreadPool::Work(size_t worker)
+{
+    size_t seen = 0;
+    std::unique_lock<std::mutex> lock(mutex);
+
+    while(true)
+    {
+        wake.wait(lock, [&]() { return stop || generation != seen; });
+        if(stop)
+            return;
+
+        seen = generation;
+        lock.unlock();
+
+        // Chunks are claimed dynamically, so uneven work still balances out
+        for(size_t begin = next.fetch_add(chunk); begin < count; begin = next.fetch_add(chunk))
+            (*job)(worker, begin, std::min(begin + chunk, count));
+
+        lock.lock();
+        if(--busy == 0)
+            done.notify_all();
+    }
+}
\ No newline at end of file
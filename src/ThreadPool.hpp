@@ -0,0 +1,44 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Fixed set of worker threads for data parallel loops. Workers are numbered,
+// so callers can keep per-worker scratch state without any locking.
+class ThreadPool
+{
+public:
+    // Called with the worker number and a range [begin, end) of indices
+    using Job = std::function<void(size_t worker, size_t begin, size_t end)>;
+
+    ThreadPool(size_t threads = std::thread::hardware_concurrency());
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool& other) = delete;
+    ThreadPool& operator=(const ThreadPool& other) = delete;
+
+    // Hands out [0, count) in chunks to the workers and blocks until all are done
+    void ParallelFor(size_t count, size_t chunk, const Job& job);
+
+    inline size_t GetThreadCount() const { return threads.size(); }
+
+private:
+    void Work(size_t worker);
+
+private:
+    std::vector<std::thread> threads;
+
+    std::mutex mutex;
+    std::condition_variable wake, done;
+    bool stop = false;
+
+    const Job* job = nullptr;
+    size_t generation = 0;
+    size_t busy = 0;
+    size_t count = 0, chunk = 1;
+    std::atomic<size_t> next;
+};
\ No newline at end of file
@@ -1,55 +1,26 @@
 #include "Topology.hpp"
 
+#include <algorithm>
 #include <vector>
+#include <glad/glad.h>
 
 #include "Util.hpp"
 #include "Colormaps.hpp"
+#include "ValueRange.hpp"
+#include "TopologyShader.hpp"
 
-Topology::Topology(lol::ObjectManager& manager, const glm::vec2& size, const glm::uvec2& subdivisions) :
-	texture(nullptr), manager(manager)
+Topology::Topology(lol::ObjectManager& manager, const glm::vec2& size, const glm::uvec2& subdivisions, TextureStorage storage) :
+	extent(size), heightmap(subdivisions.x, subdivisions.y, storage), manager(manager)
 {
-	// Create VAO
+	// lol draws a drawable's VAO with one indexed draw call, which can't be
+	// instanced. It gets an empty one, PreRender() draws the grid itself
 	vao = std::make_shared<lol::VertexArray>();
-	
-	std::vector<float> vertices;
-	std::vector<unsigned int> indices;
-	for (unsigned int y = 0; y < subdivisions.y; y++)
-	{
-		float yCoord = Map(glm::vec2(0, subdivisions.y), 0.5f * size.y * glm::vec2(-1.0f, 1.0f), y);
-		for (unsigned int x = 0; x < subdivisions.x; x++)
-		{
-			float xCoord = Map(glm::vec2(0, subdivisions.x), 0.5f * size.x * glm::vec2(-1.0f, 1.0f), x);
-
-			vertices.push_back(xCoord);
-			vertices.push_back(yCoord);
-			vertices.push_back(Map(glm::vec2(-1, subdivisions.x + 1), glm::vec2(0.0f, 1.0f), x));
-			vertices.push_back(Map(glm::vec2(-1, subdivisions.y + 1), glm::vec2(0.0f, 1.0f), y));
-
-			if (y > 0 && x > 0)
-			{
-				indices.push_back(y * subdivisions.x + x);
-				indices.push_back(y * subdivisions.x + (x - 1));
-				indices.push_back((y - 1) * subdivisions.x + (x - 1));
-
-				indices.push_back(y * subdivisions.x + x);
-				indices.push_back((y - 1)* subdivisions.x + (x - 1));
-				indices.push_back((y - 1)* subdivisions.x + x);
-			}
-		}
-	}
-
-	std::shared_ptr<lol::VertexBuffer> vertexBuffer = std::make_shared<lol::VertexBuffer>(vertices);
-	vertexBuffer->SetLayout(
-		{
-			{ lol::Type::Float, 2, false },
-			{ lol::Type::Float, 2, false }
-		}
-	);
-
-	std::shared_ptr<lol::ElementBuffer> elementBuffer = std::make_shared<lol::ElementBuffer>(indices);
+	vao->SetVertexBuffer(std::make_shared<lol::VertexBuffer>(std::vector<float>()));
+	vao->SetElementBuffer(std::make_shared<lol::ElementBuffer>(std::vector<unsigned int>()));
 
-	vao->SetVertexBuffer(vertexBuffer);
-	vao->SetElementBuffer(elementBuffer);
+	// The grid has no vertex data at all, the shader derives every vertex
+	// from its IDs. Core profiles still need some VAO bound to draw
+	glGenVertexArrays(1, &grid);
 
 	// Set up shader
 	try
@@ -59,57 +30,14 @@ Topology::Topology(lol::ObjectManager& manager, const glm::vec2& size, const glm
 	catch(const lol::ObjectNotFoundException& ex)
 	{
 		shader = manager.Create<lol::Shader>(TOPOLOGY_ID,
-			R"(
-				#version 460 core
-
-				layout (location = 0) in vec2 position;
-				layout (location = 1) in vec2 texCoord;
-
-				out float height;
-
-				uniform mat4 view;
-				uniform mat4 projection;
-				uniform float offset;
-				uniform float heightFactor;
-
-				uniform sampler2D heightmap;
-
-				void main()
-				{
-					height = texture(heightmap, vec2(texCoord.x + offset, texCoord.y)).x;
-					gl_Position = projection * view * vec4(position.x, heightFactor * height, position.y, 1.0f);
-				}
-			)",
-			R"(
-				#version 460 core
-
-				in float height;
-
-				out vec4 FragColor;
-
-				uniform bool renderColormap;
-				uniform vec2 range;
-				uniform sampler1D colormap;
-
-				float normalize(float val)
-				{
-					return (val - range.x) / (range.y - range.x);
-				}
-
-				void main()
-				{
-					vec4 color = vec4(1.0f);
-					if(renderColormap)
-						color = texture(colormap, normalize(height));
-
-					FragColor = color;
-				}
-			)"
+			TOPOLOGY_VERTEX_SHADER,
+			TOPOLOGY_FRAGMENT_SHADER
 		);
 	}
 
-	// Generate image
-	image = lol::Image(subdivisions.x, subdivisions.y, lol::PixelFormat::R, lol::PixelType::Float);
+	// Generate the column history
+	dims = subdivisions;
+	pixels.assign((size_t)dims.x * dims.y, 0.0f);
 
 	// Generate colormap
 	for(const Colormap& cm : colormaps)
@@ -122,39 +50,49 @@ Topology::~Topology()
 {
 	manager.ClearUnused();
 
-	if (texture != nullptr)
-		delete texture;
+	glDeleteVertexArrays(1, &grid);
 }
 
 void Topology::PreRender(const lol::CameraBase& camera) 
 {
-	if(texture != nullptr)
-		texture->Bind();
+	// Columns put off by an earlier update get another chance every frame
+	heightmap.Flush(pixels.data());
+
+	glActiveTexture(GL_TEXTURE0);
+	glBindTexture(GL_TEXTURE_2D, heightmap.GetTexture());
 
+	glActiveTexture(GL_TEXTURE1);
 	colormap->Bind();
+	glActiveTexture(GL_TEXTURE0);
 
 	shader->SetUniform("view", camera.GetView());
 	shader->SetUniform("projection", camera.GetProjection());
 	shader->SetUniform("offset", offset);
 
 	shader->SetUniform("heightFactor", heightFactor);
+	const TexelFormat& format = heightmap.GetFormat();
+	shader->SetUniform("logarithmic", format.IsLogarithmic());
+	shader->SetUniform("logRange", glm::vec2(format.logMin, format.logMax));
 	shader->SetUniform("range", range);
 	shader->SetUniform("renderColormap", renderColor);
+	shader->SetUniform("size", extent);
+	shader->SetUniform("subdivisions", glm::vec2((float)dims.x, (float)dims.y));
 
 	offset += 0.01f * scroll;
+
+	if (dims.x < 2 || dims.y < 2)
+		return;
+
+	shader->Use();
+	glBindVertexArray(grid);
+	glDrawArraysInstanced(GL_TRIANGLE_STRIP, 0, 2 * dims.x, dims.y - 1);
+	glBindVertexArray(0);
 }
 
 void Topology::CalculateRange()
 {
-	float* pixels = GetTopology();
-
-	range = glm::vec2(pixels[0]);
-	unsigned int size = image.GetDimensions().x * image.GetDimensions().y;
-	for (unsigned int i = 1; i < size; i++)
-	{
-		range.x = std::min(pixels[i], range.x);
-		range.y = std::max(pixels[i], range.y);
-	}
+	ValueRange found = FindRange(pixels.data(), pixels.size());
+	range = glm::vec2(found.minimum, found.maximum);
 }
 
 void Topology::SetColormap(const Colormap& cm)
@@ -184,11 +122,16 @@ void Topology::RegisterColormap(const Colormap& cm)
 
 void Topology::MakeTexture()
 {
-	// Calculate range (min, max values) of topology
-	float* pixels = (float*)image.GetPixels();
+	UploadColumns(0, dims.x);
+}
 
-	if (texture != nullptr)
-		delete texture;
+void Topology::SetLogRange(float logMin, float logMax)
+{
+	if (heightmap.SetLogRange(logMin, logMax))
+		MakeTexture();
+}
 
-	texture = new lol::Texture2D(image, lol::TextureFormat::R32F);
+void Topology::UploadColumns(unsigned int first, unsigned int count)
+{
+	heightmap.Upload(pixels.data(), first, count);
 }
@@ -1,7 +1,9 @@
 #pragma once
 
+#include <memory>
 #include <lol/lol.hpp>
 #include "Colormaps.hpp"
+#include "HeightmapTexture.hpp"
 
 inline float Map(const glm::vec2& from, const glm::vec2& to, float val)
 {
@@ -11,7 +13,7 @@ inline float Map(const glm::vec2& from, const glm::vec2& to, float val)
 class Topology : public lol::Drawable
 {
 public:
-	Topology(lol::ObjectManager& manager, const glm::vec2& size, const glm::uvec2& subdivision);
+	Topology(lol::ObjectManager& manager, const glm::vec2& size, const glm::uvec2& subdivision, TextureStorage storage = TextureStorage::Float);
 	~Topology();
 
 	void PreRender(const lol::CameraBase& camera) override;
@@ -20,19 +22,44 @@ public:
 	inline void SetColorMapping(bool enable) { renderColor = enable; }
 	inline virtual void Scroll(bool enable) { scroll = enable; }
 
-	inline float* GetTopology() const { return (float*)image.GetPixels(); };
-	inline const glm::uvec2& GetSize() const { return image.GetDimensions(); };
+	// The history is a ring of GetSize().x columns of GetSize().y values each.
+	// It is stored column after column, so a column is written sequentially
+	inline float* GetTopology() { return pixels.data(); };
+	inline float* GetColumn(unsigned int column) { return pixels.data() + (size_t)(column % dims.x) * dims.y; }
+	inline const glm::uvec2& GetSize() const { return dims; };
 
 	void CalculateRange();
 	void SetColormap(const Colormap& cm);
+
+	// Uploads the whole image
 	void MakeTexture();
 
+	// Uploads count columns from first on, wrapping around the right edge
+	// like the ring the columns are written to. Never waits for the driver,
+	// columns that can't go up yet are merged with the next upload
+	void UploadColumns(unsigned int first, unsigned int count);
+
+	// Magnitudes the logarithmic storage modes can represent, as log2 of the
+	// smallest and the largest one. Changing it uploads the whole image again
+	void SetLogRange(float logMin, float logMax);
+	inline const TexelFormat& GetTexelFormat() const { return heightmap.GetFormat(); }
+
+	// Uploads that had to be put off because the driver was still busy
+	inline uint64_t GetDeferredUploads() const { return heightmap.GetDeferredUploads(); }
+
 private:
 	void RegisterColormap(const Colormap& cm);
 
 protected:
-	lol::Image image;
-	lol::Texture2D* texture;
+	glm::vec2 extent;
+	glm::uvec2 dims;
+	std::vector<float> pixels;
+
+	// Empty, the grid vertices are generated in the vertex shader
+	unsigned int grid = 0;
+
+	// Transposed like the history, the columns are updated in place
+	HeightmapTexture heightmap;
 
 	lol::ObjectManager& manager;
 	std::shared_ptr<lol::Texture1D> colormap;
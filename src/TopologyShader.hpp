@@ -0,0 +1,65 @@
+#pragma once
+
+// Sources of the topology shader. GLSL 4.50 is all they need, which keeps
+// them running on Mesa's software renderer as well. The grid has no vertex
+// data, the vertex shader derives every vertex from its IDs
+inline const char* const TOPOLOGY_VERTEX_SHADER = R"(
+	#version 450 core
+
+	out float height;
+
+	uniform mat4 view;
+	uniform mat4 projection;
+	uniform float offset;
+	uniform float heightFactor;
+
+	// Samplers of different types can't share a texture unit
+	layout (binding = 0) uniform sampler2D heightmap;
+	uniform bool logarithmic;
+	uniform vec2 logRange;
+
+	// One triangle strip per pair of neighbouring grid rows, the
+	// instance picks the pair and the vertex walks along it. Every
+	// quad is split along its diagonal from (x - 1, y - 1) to (x, y)
+	uniform vec2 size;
+	uniform vec2 subdivisions;
+
+	void main()
+	{
+		vec2 index = vec2(gl_VertexID >> 1, gl_InstanceID + 1 - (gl_VertexID & 1));
+		vec2 position = size * (index / subdivisions - 0.5f);
+		vec2 texCoord = (index + 1.0f) / (subdivisions + 2.0f);
+
+		height = texture(heightmap, vec2(texCoord.y, texCoord.x + offset)).x;
+		if(logarithmic)
+			height = exp2(mix(logRange.x, logRange.y, height));
+
+		gl_Position = projection * view * vec4(position.x, heightFactor * height, position.y, 1.0f);
+	}
+)";
+
+inline const char* const TOPOLOGY_FRAGMENT_SHADER = R"(
+	#version 450 core
+
+	in float height;
+
+	out vec4 FragColor;
+
+	uniform bool renderColormap;
+	uniform vec2 range;
+	layout (binding = 1) uniform sampler1D colormap;
+
+	float normalize(float val)
+	{
+		return (val - range.x) / (range.y - range.x);
+	}
+
+	void main()
+	{
+		vec4 color = vec4(1.0f);
+		if(renderColormap)
+			color = texture(colormap, normalize(height));
+
+		FragColor = color;
+	}
+)";
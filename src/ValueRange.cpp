@@ -0,0 +1,19 @@
+#include "ValueRange.hpp"
+
+#include <algorithm>
+
+ValueRange FindRange(const float* values, size_t count)
+{
+    ValueRange range;
+    if(count == 0)
+        return range;
+
+    range.minimum = range.maximum = values[0];
+    for(size_t i = 1; i < count; i++)
+    {
+        range.minimum = std::min(values[i], range.minimum);
+        range.maximum = std::max(values[i], range.maximum);
+    }
+
+    return range;
+}
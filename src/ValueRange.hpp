@@ -0,0 +1,13 @@
+#pragma once
+
+#include <cstddef>
+
+// Smallest and largest of a set of values
+struct ValueRange
+{
+    float minimum = 0.0f;
+    float maximum = 0.0f;
+};
+
+// Range of count values, all zero if there are none
+ValueRange FindRange(const float* values, size_t count);
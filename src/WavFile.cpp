@@ -0,0 +1,140 @@
+#include "WavFile.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+#define WAVE_FORMAT_PCM         0x0001
+#define WAVE_FORMAT_IEEE_FLOAT  0x0003
+#define WAVE_FORMAT_EXTENSIBLE  0xFFFE
+
+static uint32_t Read32(const uint8_t* ptr, bool bigEndian)
+{
+    if(bigEndian)
+        return ((uint32_t)ptr[0] << 24) | ((uint32_t)ptr[1] << 16) | ((uint32_t)ptr[2] << 8) | ptr[3];
+
+    return ((uint32_t)ptr[3] << 24) | ((uint32_t)ptr[2] << 16) | ((uint32_t)ptr[1] << 8) | ptr[0];
+}
+
+static uint16_t Read16(const uint8_t* ptr, bool bigEndian)
+{
+    if(bigEndian)
+        return (uint16_t)((ptr[0] << 8) | ptr[1]);
+
+    return (uint16_t)((ptr[1] << 8) | ptr[0]);
+}
+
+WavLayout ParseWav(const ByteReader& read, uint64_t fileSize, const std::string& name)
+{
+    WavLayout layout;
+
+    uint8_t header[12];
+    if(fileSize < 12 || read(0, header, 12) != 12 || std::memcmp(header + 8, "WAVE", 4) != 0)
+        throw std::runtime_error("\"" + name + "\" is not a WAVE file");
+
+    if(std::memcmp(header, "RIFF", 4) == 0)
+        layout.bigEndian = false;
+    else if(std::memcmp(header, "RIFX", 4) == 0)
+        layout.bigEndian = true;
+    else
+        throw std::runtime_error("\"" + name + "\" is not a RIFF file");
+
+    bool hasFormat = false, hasData = false;
+    uint16_t formatTag = 0, bits = 0, blockAlign = 0;
+    uint64_t dataSize = 0;
+
+    // Walk the chunks, they are padded to an even size
+    uint64_t offset = 12;
+    while(offset + 8 <= fileSize && !(hasFormat && hasData))
+    {
+        uint8_t chunk[8];
+        if(read(offset, chunk, 8) != 8)
+            break;
+
+        uint64_t chunkSize = Read32(chunk + 4, layout.bigEndian);
+        uint64_t available = fileSize - offset - 8;
+
+        if(std::memcmp(chunk, "fmt ", 4) == 0)
+        {
+            uint8_t format[40] = {};
+            if(chunkSize < 16 || chunkSize > available)
+                throw std::runtime_error("\"" + name + "\" has a broken format chunk");
+
+            size_t formatSize = (size_t)std::min<uint64_t>(chunkSize, sizeof(format));
+            if(read(offset + 8, format, formatSize) != formatSize)
+                throw std::runtime_error("\"" + name + "\" has a broken format chunk");
+
+            formatTag = Read16(format, layout.bigEndian);
+            layout.channels = Read16(format + 2, layout.bigEndian);
+            layout.sampleRate = Read32(format + 4, layout.bigEndian);
+            blockAlign = Read16(format + 12, layout.bigEndian);
+            bits = Read16(format + 14, layout.bigEndian);
+
+            // The actual format is the first two bytes of the sub format GUID
+            if(formatTag == WAVE_FORMAT_EXTENSIBLE && chunkSize >= 40)
+                formatTag = Read16(format + 24, layout.bigEndian);
+
+            hasFormat = true;
+        }
+        else if(std::memcmp(chunk, "data", 4) == 0)
+        {
+            // Writers that stream the file leave the size at 0 or 0xFFFFFFFF,
+            // truncated files claim more than there is
+            if(chunkSize == 0 || chunkSize > available)
+                chunkSize = available;
+
+            layout.dataOffset = offset + 8;
+            dataSize = chunkSize;
+            hasData = true;
+        }
+
+        offset += 8 + chunkSize + (chunkSize & 1);
+    }
+
+    if(!hasFormat || !hasData)
+        throw std::runtime_error("\"" + name + "\" is missing its format or data chunk");
+
+    if(formatTag == WAVE_FORMAT_PCM && bits == 8)
+        layout.format = SampleFormat::U8;
+    else if(formatTag == WAVE_FORMAT_PCM && bits == 16)
+        layout.format = SampleFormat::S16;
+    else if(formatTag == WAVE_FORMAT_PCM && bits == 24)
+        layout.format = SampleFormat::S24;
+    else if(formatTag == WAVE_FORMAT_PCM && bits == 32)
+        layout.format = SampleFormat::S32;
+    else if(formatTag == WAVE_FORMAT_IEEE_FLOAT && bits == 32)
+        layout.format = SampleFormat::F32;
+    else
+        throw std::runtime_error("\"" + name + "\" has an unsupported sample format");
+
+    size_t frameSize = GetBytesPerSample(layout.format) * layout.channels;
+    if(layout.channels == 0 || blockAlign != frameSize)
+        throw std::runtime_error("\"" + name + "\" has an inconsistent frame size");
+
+    layout.frames = dataSize / frameSize;
+    return layout;
+}
+
+WavFile::WavFile(const std::string& path) :
+    file(path)
+{
+    const uint8_t* data = file.GetData();
+    uint64_t size = file.GetSize();
+
+    WavLayout layout = ParseWav(
+        [data, size](uint64_t offset, uint8_t* output, size_t bytes)
+        {
+            size_t count = (size_t)std::min<uint64_t>(bytes, size - std::min(offset, size));
+            std::memcpy(output, data + offset, count);
+            return count;
+        },
+        size, path
+    );
+
+    pcm.data = data + layout.dataOffset;
+    pcm.format = layout.format;
+    pcm.bigEndian = layout.bigEndian;
+    pcm.channels = layout.channels;
+    pcm.frames = layout.frames;
+    sampleRate = layout.sampleRate;
+}
\ No newline at end of file
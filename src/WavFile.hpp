@@ -0,0 +1,45 @@
+#pragma once
+
+#include <functional>
+#include <string>
+
+#include "MappedFile.hpp"
+#include "Pcm.hpp"
+
+// Where the samples of a WAV file are and how they are stored
+struct WavLayout
+{
+    SampleFormat format = SampleFormat::F32;
+    bool bigEndian = false;
+    unsigned int channels = 1;
+    unsigned int sampleRate = 0;
+
+    uint64_t dataOffset = 0;    // In bytes from the start of the file
+    uint64_t frames = 0;
+};
+
+// Copies up to bytes bytes from offset on into output, returns how many it copied
+using ByteReader = std::function<size_t(uint64_t offset, uint8_t* output, size_t bytes)>;
+
+// Walks the RIFF chunks of a file of fileSize bytes. Only the chunk headers
+// are read, never the samples. Supports integer PCM with 8, 16, 24 or 32
+// bits and 32 bit float, in both little (RIFF) and big endian (RIFX) files.
+// Throws std::runtime_error, name is only used in the messages
+WavLayout ParseWav(const ByteReader& read, uint64_t fileSize, const std::string& name);
+
+// RIFF/WAVE reader on top of a memory mapping. The data chunk is exposed as a
+// PCM view straight into the mapping, nothing is copied or converted.
+class WavFile
+{
+public:
+    // Throws std::runtime_error if the file can't be read or isn't supported
+    WavFile(const std::string& path);
+
+    inline const PcmView& GetPcm() const { return pcm; }
+    inline unsigned int GetSampleRate() const { return sampleRate; }
+
+private:
+    MappedFile file;
+    PcmView pcm;
+    unsigned int sampleRate = 0;
+};
\ No newline at end of file
@@ -0,0 +1,56 @@
+#include "Window.hpp"
+
+#include <cmath>
+
+std::vector<float> MakeWindow(WindowType type, size_t length, float beta)
+{
+    std::vector<float> window(length, 1.0f);
+    double N = (double)length;
+
+    for(size_t n = 0; n < length; n++)
+    {
+        double phi = 2.0 * M_PI * (double)n / N;
+
+        switch(type)
+        {
+        case WindowType::Rectangular:
+            break;
+
+        case WindowType::Hann:
+            window[n] = (float)(0.5 - 0.5 * std::cos(phi));
+            break;
+
+        case WindowType::BlackmanHarris:
+            window[n] = (float)(0.35875 - 0.48829 * std::cos(phi) + 0.14128 * std::cos(2.0 * phi) - 0.01168 * std::cos(3.0 * phi));
+            break;
+
+        case WindowType::Kaiser:
+        {
+            double ratio = 2.0 * (double)n / N - 1.0;
+            window[n] = (float)(BesselI0(beta * std::sqrt(1.0 - ratio * ratio)) / BesselI0(beta));
+            break;
+        }
+        }
+    }
+
+    return window;
+}
+
+double BesselI0(double x)
+{
+    // Power series, converges quickly for the betas used in windows
+    double sum = 1.0;
+    double term = 1.0;
+    double halfX = 0.5 * x;
+
+    for(int k = 1; k < 64; k++)
+    {
+        term *= (halfX / k) * (halfX / k);
+        sum += term;
+
+        if(term < sum * 1e-12)
+            break;
+    }
+
+    return sum;
+}
\ No newline at end of file
@@ -0,0 +1,18 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+enum class WindowType
+{
+    Rectangular,
+    Hann,
+    BlackmanHarris,
+    Kaiser
+};
+
+// Generates a periodic (DFT-even) analysis window. beta is only used by the Kaiser window
+std::vector<float> MakeWindow(WindowType type, size_t length, float beta = 8.6f);
+
+// Zeroth order modified Bessel function of the first kind
+double BesselI0(double x);
\ No newline at end of file
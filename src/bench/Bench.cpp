@@ -0,0 +1,83 @@
+#include "Bench.hpp"
+
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <new>
+#include <thread>
+
+#include "Simd.hpp"
+
+std::atomic<size_t> allocationCount(0);
+
+void* operator new(size_t size)
+{
+    allocationCount.fetch_add(1, std::memory_order_relaxed);
+
+    void* ptr = std::malloc(size ? size : 1);
+    if(ptr == nullptr)
+        throw std::bad_alloc();
+
+    return ptr;
+}
+
+void operator delete(void* ptr) noexcept
+{
+    std::free(ptr);
+}
+
+void operator delete(void* ptr, size_t) noexcept
+{
+    std::free(ptr);
+}
+
+BenchReport::BenchReport(double minSeconds, const std::string& filter) :
+    minSeconds(minSeconds), filter(filter)
+{
+    std::printf("%-14s %-28s %10s %14s %10s %14s\n", "group", "name", "size", "ns/op", "allocs/op", "samples/s");
+}
+
+bool BenchReport::IsEnabled(const std::string& group) const
+{
+    return filter.empty() || group.find(filter) != std::string::npos;
+}
+
+void BenchReport::Record(const std::string& group, const std::string& name, size_t size, double samplesPerOp, const Measurement& measurement)
+{
+    results.push_back({ group, name, size, samplesPerOp, measurement });
+
+    double throughput = samplesPerOp * 1e9 / measurement.nsPerOp;
+    std::printf("%-14s %-28s %10zu %14.1f %10.2f %14.4g\n",
+        group.c_str(), name.c_str(), size, measurement.nsPerOp, measurement.allocationsPerOp, throughput);
+    std::fflush(stdout);
+}
+
+bool BenchReport::WriteJson(const std::string& path) const
+{
+    std::ofstream file(path);
+    if(!file.good())
+        return false;
+
+    file << "{\n";
+    file << "  \"simd\": \"" << GetSimdKernels().name << "\",\n";
+    file << "  \"threads\": " << std::thread::hardware_concurrency() << ",\n";
+    file << "  \"results\": [\n";
+
+    for(size_t i = 0; i < results.size(); i++)
+    {
+        const BenchResult& result = results[i];
+        double throughput = result.samplesPerOp * 1e9 / result.measurement.nsPerOp;
+
+        file << "    { \"group\": \"" << result.group << "\", \"name\": \"" << result.name << "\", "
+             << "\"size\": " << result.size << ", "
+             << "\"ns_per_op\": " << result.measurement.nsPerOp << ", "
+             << "\"allocs_per_op\": " << result.measurement.allocationsPerOp << ", "
+             << "\"samples_per_second\": " << throughput << " }"
+             << (i + 1 < results.size() ? ",\n" : "\n");
+    }
+
+    file << "  ]\n";
+    file << "}\n";
+
+    return file.good();
+}
\ No newline at end of file
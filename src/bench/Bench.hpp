@@ -0,0 +1,79 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <string>
+#include <vector>
+
+// Heap allocations since startup, counted by the operator new in Bench.cpp
+extern std::atomic<size_t> allocationCount;
+
+struct Measurement
+{
+    double nsPerOp;
+    double allocationsPerOp;
+};
+
+struct BenchResult
+{
+    std::string group;
+    std::string name;
+    size_t size;
+    double samplesPerOp;
+    Measurement measurement;
+};
+
+// Runs benchmarks, prints every result as it comes in and collects them for
+// the JSON report
+class BenchReport
+{
+public:
+    BenchReport(double minSeconds, const std::string& filter);
+
+    // Whether benchmarks of this group should run at all
+    bool IsEnabled(const std::string& group) const;
+
+    // Calls func in growing batches until minSeconds have passed. The last
+    // batch is timed and its allocations are counted
+    template<typename Func>
+    Measurement Run(const std::string& group, const std::string& name, size_t size, double samplesPerOp, Func&& func)
+    {
+        using Clock = std::chrono::steady_clock;
+
+        // Warm up caches, branch predictors and lazily sized buffers
+        func();
+
+        size_t batch = 1;
+        while(true)
+        {
+            size_t allocationsBefore = allocationCount.load();
+            Clock::time_point start = Clock::now();
+
+            for(size_t i = 0; i < batch; i++)
+                func();
+
+            double elapsed = std::chrono::duration<double>(Clock::now() - start).count();
+            size_t allocations = allocationCount.load() - allocationsBefore;
+
+            if(elapsed >= minSeconds)
+            {
+                Measurement measurement = { elapsed * 1e9 / (double)batch, (double)allocations / (double)batch };
+                Record(group, name, size, samplesPerOp, measurement);
+                return measurement;
+            }
+
+            batch <<= 1;
+        }
+    }
+
+    bool WriteJson(const std::string& path) const;
+
+private:
+    void Record(const std::string& group, const std::string& name, size_t size, double samplesPerOp, const Measurement& measurement);
+
+private:
+    double minSeconds;
+    std::string filter;
+    std::vector<BenchResult> results;
+};
\ No newline at end of file
@@ -0,0 +1,801 @@
+#include "Heightmap.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdio>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <glad/glad.h>
+#include <EGL/egl.h>
+
+#include "HeightmapTexture.hpp"
+#include "TopologyShader.hpp"
+
+// Core 4.5 context on the default EGL display, without any surface. Its
+// default framebuffer is incomplete then, so it binds a framebuffer of one
+// pixel in its place. Even draws with the rasterizer off need a complete one
+class HeadlessContext
+{
+public:
+    HeadlessContext()
+    {
+        display = eglGetDisplay(EGL_DEFAULT_DISPLAY);
+        if(display == EGL_NO_DISPLAY || !eglInitialize(display, nullptr, nullptr))
+            return;
+
+        initialized = true;
+
+        const EGLint configAttributes[] = { EGL_SURFACE_TYPE, EGL_PBUFFER_BIT, EGL_RENDERABLE_TYPE, EGL_OPENGL_BIT, EGL_NONE };
+        EGLConfig config;
+        EGLint configs = 0;
+        if(!eglBindAPI(EGL_OPENGL_API) || !eglChooseConfig(display, configAttributes, &config, 1, &configs) || configs == 0)
+            return;
+
+        const EGLint contextAttributes[] = {
+            EGL_CONTEXT_MAJOR_VERSION, 4,
+            EGL_CONTEXT_MINOR_VERSION, 5,
+            EGL_CONTEXT_OPENGL_PROFILE_MASK, EGL_CONTEXT_OPENGL_CORE_PROFILE_BIT,
+            EGL_NONE
+        };
+
+        context = eglCreateContext(display, config, EGL_NO_CONTEXT, contextAttributes);
+        if(context == EGL_NO_CONTEXT)
+            return;
+
+        current = eglMakeCurrent(display, EGL_NO_SURFACE, EGL_NO_SURFACE, context) &&
+            gladLoadGLLoader((GLADloadproc)eglGetProcAddress);
+
+        if(!current)
+            return;
+
+        glGenRenderbuffers(1, &pixel);
+        glBindRenderbuffer(GL_RENDERBUFFER, pixel);
+        glRenderbufferStorage(GL_RENDERBUFFER, GL_R8, 1, 1);
+
+        glGenFramebuffers(1, &framebuffer);
+        glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+        glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, pixel);
+        glViewport(0, 0, 1, 1);
+    }
+
+    ~HeadlessContext()
+    {
+        if(current)
+        {
+            glDeleteFramebuffers(1, &framebuffer);
+            glDeleteRenderbuffers(1, &pixel);
+        }
+
+        if(context != EGL_NO_CONTEXT)
+        {
+            eglMakeCurrent(display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+            eglDestroyContext(display, context);
+        }
+
+        if(initialized)
+            eglTerminate(display);
+    }
+
+    inline bool IsCurrent() const { return current; }
+    inline GLuint GetFramebuffer() const { return framebuffer; }
+
+private:
+    EGLDisplay display = EGL_NO_DISPLAY;
+    EGLContext context = EGL_NO_CONTEXT;
+    bool initialized = false;
+    bool current = false;
+
+    GLuint framebuffer = 0;
+    GLuint pixel = 0;
+};
+
+static const char* GetStorageName(TextureStorage storage)
+{
+    switch(storage)
+    {
+    case TextureStorage::Half:  return "half";
+    case TextureStorage::Log16: return "log16";
+    case TextureStorage::Log8:  return "log8";
+    default:                    return "float";
+    }
+}
+
+// Compiles and links a program, without a fragment shader if there is none.
+// The named vertex outputs are captured with transform feedback, interleaved.
+// Prints the log and returns 0 if anything fails
+static GLuint LinkProgram(const char* vertexSource, const char* fragmentSource, const std::vector<const char*>& captured = {})
+{
+    GLuint program = glCreateProgram();
+    const char* sources[2] = { vertexSource, fragmentSource };
+    const GLenum types[2] = { GL_VERTEX_SHADER, GL_FRAGMENT_SHADER };
+
+    for(int i = 0; i < 2; i++)
+    {
+        if(sources[i] == nullptr)
+            continue;
+
+        GLuint shader = glCreateShader(types[i]);
+        glShaderSource(shader, 1, &sources[i], nullptr);
+        glCompileShader(shader);
+
+        GLint compiled = GL_FALSE;
+        glGetShaderiv(shader, GL_COMPILE_STATUS, &compiled);
+        if(!compiled)
+        {
+            char log[1024] = {};
+            glGetShaderInfoLog(shader, sizeof(log), nullptr, log);
+            std::printf("MISMATCH: shader fails to compile: %s\n", log);
+
+            glDeleteShader(shader);
+            glDeleteProgram(program);
+            return 0;
+        }
+
+        glAttachShader(program, shader);
+        glDeleteShader(shader);
+    }
+
+    if(!captured.empty())
+        glTransformFeedbackVaryings(program, (GLsizei)captured.size(), captured.data(), GL_INTERLEAVED_ATTRIBS);
+
+    glLinkProgram(program);
+
+    GLint linked = GL_FALSE;
+    glGetProgramiv(program, GL_LINK_STATUS, &linked);
+    if(!linked)
+    {
+        char log[1024] = {};
+        glGetProgramInfoLog(program, sizeof(log), nullptr, log);
+        std::printf("MISMATCH: shader fails to link: %s\n", log);
+
+        glDeleteProgram(program);
+        return 0;
+    }
+
+    return program;
+}
+
+// Keeps the GPU busy with a fullscreen triangle of pointless arithmetic, so
+// fences issued after it stay unsignaled for a while. Drivers that finish
+// every draw before returning, like llvmpipe on one core without
+// LP_NUM_THREADS, can't be stalled at all
+class GpuStall
+{
+public:
+    static constexpr GLsizei SIZE = 128;
+    static constexpr int MAX_ITERATIONS = 4096;
+
+    GpuStall()
+    {
+        program = LinkProgram(
+            R"(
+                #version 450 core
+
+                void main()
+                {
+                    gl_Position = vec4((gl_VertexID & 1) * 4 - 1, (gl_VertexID >> 1) * 4 - 1, 0.0f, 1.0f);
+                }
+            )",
+            R"(
+                #version 450 core
+
+                uniform int iterations;
+                out vec4 FragColor;
+
+                void main()
+                {
+                    float value = gl_FragCoord.x;
+                    for(int i = 0; i < iterations; i++)
+                        value = fract(sin(value) * 43758.5453f);
+
+                    FragColor = vec4(value);
+                }
+            )"
+        );
+
+        glGenTextures(1, &target);
+        glBindTexture(GL_TEXTURE_2D, target);
+        glTexStorage2D(GL_TEXTURE_2D, 1, GL_R32F, SIZE, SIZE);
+
+        GLint previous = 0;
+        glGetIntegerv(GL_DRAW_FRAMEBUFFER_BINDING, &previous);
+
+        glGenFramebuffers(1, &framebuffer);
+        glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+        glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, target, 0);
+        glBindFramebuffer(GL_FRAMEBUFFER, previous);
+
+        glGenVertexArrays(1, &vertexArray);
+    }
+
+    ~GpuStall()
+    {
+        glDeleteVertexArrays(1, &vertexArray);
+        glDeleteFramebuffers(1, &framebuffer);
+        glDeleteTextures(1, &target);
+        glDeleteProgram(program);
+    }
+
+    inline bool IsValid() const { return program != 0; }
+
+    // Whether any stall was still running when Issue() returned
+    inline bool IsObservable() const { return observable; }
+
+    // Returns whether the GPU is still busy with the stall. If not, the next
+    // one is made longer, up to MAX_ITERATIONS
+    bool Issue()
+    {
+        GLint previous = 0, viewport[4] = {};
+        glGetIntegerv(GL_DRAW_FRAMEBUFFER_BINDING, &previous);
+        glGetIntegerv(GL_VIEWPORT, viewport);
+
+        glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+        glViewport(0, 0, SIZE, SIZE);
+        glUseProgram(program);
+        glUniform1i(glGetUniformLocation(program, "iterations"), iterations);
+        glBindVertexArray(vertexArray);
+        glDrawArrays(GL_TRIANGLES, 0, 3);
+        glBindVertexArray(0);
+        glBindFramebuffer(GL_FRAMEBUFFER, previous);
+        glViewport(viewport[0], viewport[1], viewport[2], viewport[3]);
+
+        GLsync probe = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+        bool busy = glClientWaitSync(probe, GL_SYNC_FLUSH_COMMANDS_BIT, 0) == GL_TIMEOUT_EXPIRED;
+        glDeleteSync(probe);
+
+        if(busy)
+            seen = true;
+        else
+            Lengthen();
+
+        return busy;
+    }
+
+    // For GPUs that got through the last stall before anything waited on it
+    void Lengthen()
+    {
+        if(iterations < MAX_ITERATIONS)
+            iterations *= 2;
+        else
+            observable = seen;
+    }
+
+private:
+    GLuint program = 0;
+    GLuint target = 0;
+    GLuint framebuffer = 0;
+    GLuint vertexArray = 0;
+    int iterations = 64;
+    bool seen = false;
+    bool observable = true;
+};
+
+// Runs of random columns are written into the ring and uploaded like
+// Spectrogram::Update does, then the texture is read back. It has to be
+// transposed and hold exactly what TexelFormat::Convert makes of the
+// history, whatever unpack row length was left set.
+//
+// While streaming, the GPU is stalled as the ring is about to wrap. Uploads
+// behind the stall are declined by the fence polling and merged into one
+// pending range, which has to go up in two blocks once the stall is over.
+// The merging is followed on the side and checked after every upload
+static bool CheckUploads(BenchReport& report, TextureStorage storage, bool stream, GpuStall& stall)
+{
+    const unsigned int columns = 200, rows = 1999;
+    const char* mode = stream ? "streamed" : "synchronous";
+
+    HeightmapTexture heightmap(columns, rows, storage, stream);
+    heightmap.SetLogRange(-24.0f, -4.0f);
+    const TexelFormat& format = heightmap.GetFormat();
+
+    GLint width = 0, height = 0, internalFormat = 0;
+    glBindTexture(GL_TEXTURE_2D, heightmap.GetTexture());
+    glGetTexLevelParameteriv(GL_TEXTURE_2D, 0, GL_TEXTURE_WIDTH, &width);
+    glGetTexLevelParameteriv(GL_TEXTURE_2D, 0, GL_TEXTURE_HEIGHT, &height);
+    glGetTexLevelParameteriv(GL_TEXTURE_2D, 0, GL_TEXTURE_INTERNAL_FORMAT, &internalFormat);
+
+    if(width != (GLint)rows || height != (GLint)columns || internalFormat != (GLint)format.GetInternalFormat())
+    {
+        std::printf("MISMATCH: %s texture is %dx%d of format %x instead of %ux%u of %x\n",
+            GetStorageName(storage), width, height, internalFormat, rows, columns, format.GetInternalFormat());
+        return false;
+    }
+
+    // Left behind by someone else, the uploads have to set their own
+    glPixelStorei(GL_UNPACK_ROW_LENGTH, 7);
+
+    std::vector<float> image((size_t)columns * rows, 0.0f);
+    auto matches = [&]()
+    {
+        std::vector<uint8_t> expected(image.size() * format.GetSize()), actual(expected.size());
+        format.Convert(image.data(), image.size(), expected.data());
+
+        glBindTexture(GL_TEXTURE_2D, heightmap.GetTexture());
+        glPixelStorei(GL_PACK_ALIGNMENT, 1);
+        glGetTexImage(GL_TEXTURE_2D, 0, GL_RED, format.GetPixelType(), actual.data());
+
+        return expected == actual;
+    };
+
+    std::mt19937 rng(13);
+    std::uniform_real_distribution<float> magnitude(0.0f, 0.05f);
+
+    unsigned int next = 0;
+    unsigned int pendingFirst = 0, pendingCount = 0, pendingUploads = 0;
+    bool declined = false, mergedWrap = false, valid = true;
+    int stalledAt = -1;
+
+    for(int frame = 0; frame < 1000 && valid; frame++)
+    {
+        if(stream && stalledAt < 0 && next >= columns - 40 && stall.IsObservable() && stall.Issue())
+        {
+            stalledAt = frame;
+            declined = false;
+        }
+
+        unsigned int count = 1 + rng() % 7;
+        for(unsigned int i = 0; i < count; i++)
+        {
+            float* column = image.data() + (size_t)((next + i) % columns) * rows;
+            for(unsigned int y = 0; y < rows; y++)
+                column[y] = magnitude(rng);
+        }
+
+        if(pendingCount == 0)
+        {
+            pendingFirst = next;
+            pendingCount = count;
+        }
+        else if(next == (pendingFirst + pendingCount) % columns)
+        {
+            pendingCount = std::min(pendingCount + count, columns);
+        }
+        else
+        {
+            pendingFirst = 0;
+            pendingCount = columns;
+        }
+
+        pendingUploads++;
+
+        uint64_t deferred = heightmap.GetDeferredUploads();
+        heightmap.Upload(image.data(), next, count);
+
+        if(heightmap.GetDeferredUploads() > deferred)
+        {
+            declined = true;
+        }
+        else
+        {
+            mergedWrap = mergedWrap || (pendingUploads > 1 && pendingFirst + pendingCount > columns);
+            pendingCount = 0;
+            pendingUploads = 0;
+        }
+
+        if(heightmap.GetPendingColumns() != pendingCount)
+        {
+            std::printf("MISMATCH: %s %s upload %d left %u columns pending instead of %u\n",
+                GetStorageName(storage), mode, frame, heightmap.GetPendingColumns(), pendingCount);
+            valid = false;
+        }
+
+        next = (next + count) % columns;
+
+        // Well past the wrap, the stall is waited out and whatever is pending
+        // has to go up with the next flush
+        if(stalledAt >= 0 && frame - stalledAt == 30)
+        {
+            glFinish();
+            heightmap.Flush(image.data());
+
+            mergedWrap = mergedWrap || (pendingUploads > 1 && pendingFirst + pendingCount > columns);
+            pendingCount = pendingUploads = 0;
+
+            if(heightmap.GetPendingColumns() != 0 || !matches())
+            {
+                std::printf("MISMATCH: %s texture differs from the history after a stall\n", GetStorageName(storage));
+                valid = false;
+            }
+
+            if(!declined)
+                stall.Lengthen();
+
+            stalledAt = -1;
+        }
+    }
+
+    glFinish();
+    heightmap.Flush(image.data());
+
+    if(valid && (heightmap.GetPendingColumns() != 0 || !matches()))
+    {
+        std::printf("MISMATCH: %s %s texture differs from the history\n", GetStorageName(storage), mode);
+        valid = false;
+    }
+
+    if(stream && !mergedWrap && stall.IsObservable())
+    {
+        std::printf("MISMATCH: %s uploads were never declined and merged across the wrap\n", GetStorageName(storage));
+        valid = false;
+    }
+
+    if(stream)
+    {
+        std::printf("  %s: %llu uploads declined\n", GetStorageName(storage), (unsigned long long)heightmap.GetDeferredUploads());
+
+        report.Run("heightmap", std::string("upload/") + GetStorageName(storage), rows, 4.0 * rows, [&]()
+        {
+            heightmap.Upload(image.data(), next, 4);
+            next = (next + 4) % columns;
+        });
+
+        glFinish();
+    }
+
+    return valid;
+}
+
+// Vertex outputs of one draw with the rasterizer off, as triangles of
+// interleaved height and gl_Position. Empty if the draw didn't yield
+// vertices / 3 triangles
+template<typename Draw>
+static std::vector<float> Capture(GLuint program, size_t vertices, Draw&& draw)
+{
+    std::vector<float> captured(vertices * 5);
+
+    GLuint query;
+    glGenQueries(1, &query);
+
+    GLuint buffer;
+    glGenBuffers(1, &buffer);
+    glBindBuffer(GL_TRANSFORM_FEEDBACK_BUFFER, buffer);
+    glBufferData(GL_TRANSFORM_FEEDBACK_BUFFER, captured.size() * sizeof(float), nullptr, GL_STATIC_READ);
+    glBindBufferBase(GL_TRANSFORM_FEEDBACK_BUFFER, 0, buffer);
+
+    glEnable(GL_RASTERIZER_DISCARD);
+    glUseProgram(program);
+    glBeginQuery(GL_TRANSFORM_FEEDBACK_PRIMITIVES_WRITTEN, query);
+    glBeginTransformFeedback(GL_TRIANGLES);
+    draw();
+    glEndTransformFeedback();
+    glEndQuery(GL_TRANSFORM_FEEDBACK_PRIMITIVES_WRITTEN);
+    glDisable(GL_RASTERIZER_DISCARD);
+
+    GLuint triangles = 0;
+    glGetQueryObjectuiv(query, GL_QUERY_RESULT, &triangles);
+    glDeleteQueries(1, &query);
+
+    glGetBufferSubData(GL_TRANSFORM_FEEDBACK_BUFFER, 0, captured.size() * sizeof(float), captured.data());
+    glBindBufferBase(GL_TRANSFORM_FEEDBACK_BUFFER, 0, 0);
+    glDeleteBuffers(1, &buffer);
+
+    if(triangles * 3 != vertices)
+    {
+        std::printf("MISMATCH: captured %u triangles instead of %zu\n", triangles, vertices / 3);
+        captured.clear();
+    }
+
+    return captured;
+}
+
+// Everything PreRender sets, with an identity camera so gl_Position is the
+// grid position itself
+static void SetUniforms(GLuint program, unsigned int columns, unsigned int rows, const TexelFormat& format, float size)
+{
+    const float identity[16] = { 1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f };
+
+    glUseProgram(program);
+    glUniformMatrix4fv(glGetUniformLocation(program, "view"), 1, GL_FALSE, identity);
+    glUniformMatrix4fv(glGetUniformLocation(program, "projection"), 1, GL_FALSE, identity);
+    glUniform1f(glGetUniformLocation(program, "offset"), 0.37f);
+    glUniform1f(glGetUniformLocation(program, "heightFactor"), 200.0f);
+    glUniform1i(glGetUniformLocation(program, "logarithmic"), format.IsLogarithmic());
+    glUniform2f(glGetUniformLocation(program, "logRange"), format.logMin, format.logMax);
+    glUniform2f(glGetUniformLocation(program, "size"), size, size);
+    glUniform2f(glGetUniformLocation(program, "subdivisions"), (float)columns, (float)rows);
+}
+
+// Vertex shader of the indexed grid the procedural one replaced
+static const char* INDEXED_VERTEX_SHADER = R"(
+    #version 450 core
+
+    layout (location = 0) in vec2 position;
+    layout (location = 1) in vec2 texCoord;
+
+    out float height;
+
+    uniform mat4 view;
+    uniform mat4 projection;
+    uniform float offset;
+    uniform float heightFactor;
+
+    uniform sampler2D heightmap;
+    uniform bool logarithmic;
+    uniform vec2 logRange;
+
+    void main()
+    {
+        height = texture(heightmap, vec2(texCoord.y, texCoord.x + offset)).x;
+        if(logarithmic)
+            height = exp2(mix(logRange.x, logRange.y, height));
+
+        gl_Position = projection * view * vec4(position.x, heightFactor * height, position.y, 1.0f);
+    }
+)";
+
+// The instanced strips of the topology shader against the indexed mesh the
+// grid used to be, built and drawn the way Topology did before. Both have to
+// yield the same triangles with the same winding and the same heights. The
+// triangles are matched up by their grid vertices, each rotated to start at
+// its lowest one. The topology shader is linked whole, the draw only goes
+// through if its samplers don't share a texture unit
+static bool CheckGrid()
+{
+    const unsigned int columns = 37, rows = 53;
+    const float size = 5.0f;
+    const size_t vertices = 6 * (size_t)(columns - 1) * (rows - 1);
+
+    std::vector<float> image((size_t)columns * rows);
+    std::mt19937 rng(17);
+    std::uniform_real_distribution<float> magnitude(0.0f, 1.0f);
+    for(float& value : image)
+        value = magnitude(rng);
+
+    HeightmapTexture heightmap(columns, rows, TextureStorage::Float, false);
+    heightmap.Upload(image.data(), 0, columns);
+
+    GLuint procedural = LinkProgram(TOPOLOGY_VERTEX_SHADER, TOPOLOGY_FRAGMENT_SHADER, { "height", "gl_Position" });
+    GLuint indexed = LinkProgram(INDEXED_VERTEX_SHADER, nullptr, { "height", "gl_Position" });
+    if(procedural == 0 || indexed == 0)
+        return false;
+
+    auto map = [](float fromMin, float fromMax, float toMin, float toMax, float value)
+    {
+        return (value - fromMin) * (toMax - toMin) / (fromMax - fromMin) + toMin;
+    };
+
+    std::vector<float> mesh;
+    std::vector<unsigned int> indices;
+    for(unsigned int y = 0; y < rows; y++)
+    {
+        for(unsigned int x = 0; x < columns; x++)
+        {
+            mesh.push_back(map(0.0f, (float)columns, -0.5f * size, 0.5f * size, (float)x));
+            mesh.push_back(map(0.0f, (float)rows, -0.5f * size, 0.5f * size, (float)y));
+            mesh.push_back(map(-1.0f, (float)columns + 1.0f, 0.0f, 1.0f, (float)x));
+            mesh.push_back(map(-1.0f, (float)rows + 1.0f, 0.0f, 1.0f, (float)y));
+
+            if(y > 0 && x > 0)
+            {
+                unsigned int quad[6] = {
+                    y * columns + x, y * columns + (x - 1), (y - 1) * columns + (x - 1),
+                    y * columns + x, (y - 1) * columns + (x - 1), (y - 1) * columns + x
+                };
+
+                indices.insert(indices.end(), quad, quad + 6);
+            }
+        }
+    }
+
+    GLuint meshArray, meshBuffer, elementBuffer, emptyArray;
+    glGenVertexArrays(1, &meshArray);
+    glBindVertexArray(meshArray);
+    glGenBuffers(1, &meshBuffer);
+    glBindBuffer(GL_ARRAY_BUFFER, meshBuffer);
+    glBufferData(GL_ARRAY_BUFFER, mesh.size() * sizeof(float), mesh.data(), GL_STATIC_DRAW);
+    glGenBuffers(1, &elementBuffer);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, elementBuffer);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(unsigned int), indices.data(), GL_STATIC_DRAW);
+    glEnableVertexAttribArray(0);
+    glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 4 * sizeof(float), nullptr);
+    glEnableVertexAttribArray(1);
+    glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 4 * sizeof(float), reinterpret_cast<const void*>(2 * sizeof(float)));
+    glGenVertexArrays(1, &emptyArray);
+
+    glActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_2D, heightmap.GetTexture());
+
+    SetUniforms(indexed, columns, rows, heightmap.GetFormat(), size);
+    std::vector<float> expected = Capture(indexed, vertices, [&]()
+    {
+        glBindVertexArray(meshArray);
+        glDrawElements(GL_TRIANGLES, (GLsizei)indices.size(), GL_UNSIGNED_INT, nullptr);
+    });
+
+    SetUniforms(procedural, columns, rows, heightmap.GetFormat(), size);
+    std::vector<float> actual = Capture(procedural, vertices, [&]()
+    {
+        glBindVertexArray(emptyArray);
+        glDrawArraysInstanced(GL_TRIANGLE_STRIP, 0, 2 * columns, rows - 1);
+    });
+
+    glBindVertexArray(0);
+    glDeleteVertexArrays(1, &emptyArray);
+    glDeleteBuffers(1, &elementBuffer);
+    glDeleteBuffers(1, &meshBuffer);
+    glDeleteVertexArrays(1, &meshArray);
+    glDeleteProgram(indexed);
+    glDeleteProgram(procedural);
+
+    if(expected.empty() || actual.empty())
+        return false;
+
+    // Grid vertex of every captured vertex, and the triangles in the order
+    // of their rotated grid vertices
+    auto sortTriangles = [&](const std::vector<float>& captured)
+    {
+        std::vector<std::array<long, 4>> triangles(vertices / 3);
+        for(size_t t = 0; t < triangles.size(); t++)
+        {
+            long keys[3];
+            for(size_t v = 0; v < 3; v++)
+            {
+                const float* vertex = captured.data() + (3 * t + v) * 5;
+                long x = std::lround((vertex[1] / size + 0.5f) * columns);
+                long y = std::lround((vertex[3] / size + 0.5f) * rows);
+                keys[v] = y * (long)columns + x;
+            }
+
+            size_t lowest = std::min_element(keys, keys + 3) - keys;
+            triangles[t] = { keys[lowest], keys[(lowest + 1) % 3], keys[(lowest + 2) % 3], (long)(3 * t + lowest) };
+        }
+
+        std::sort(triangles.begin(), triangles.end());
+        return triangles;
+    };
+
+    std::vector<std::array<long, 4>> expectedTriangles = sortTriangles(expected);
+    std::vector<std::array<long, 4>> actualTriangles = sortTriangles(actual);
+
+    double maxDifference = 0.0;
+    for(size_t t = 0; t < expectedTriangles.size(); t++)
+    {
+        const std::array<long, 4>& a = expectedTriangles[t];
+        const std::array<long, 4>& b = actualTriangles[t];
+        if(a[0] != b[0] || a[1] != b[1] || a[2] != b[2])
+        {
+            std::printf("MISMATCH: grid triangle %ld %ld %ld is %ld %ld %ld in the instanced strips\n", a[0], a[1], a[2], b[0], b[1], b[2]);
+            return false;
+        }
+
+        // Both start at the lowest grid vertex, the rest follows in winding order
+        for(size_t v = 0; v < 3; v++)
+        {
+            const float* first = expected.data() + (a[3] - a[3] % 3 + (a[3] % 3 + v) % 3) * 5;
+            const float* second = actual.data() + (b[3] - b[3] % 3 + (b[3] % 3 + v) % 3) * 5;
+
+            for(size_t i = 0; i < 5; i++)
+                maxDifference = std::max(maxDifference, (double)std::abs(first[i] - second[i]) / (i == 2 ? 200.0 : 1.0));
+        }
+    }
+
+    // Heights may differ by a step of the filter weights, the positions only
+    // by rounding
+    if(maxDifference > 1e-3)
+    {
+        std::printf("MISMATCH: instanced grid differs from the indexed mesh by %g\n", maxDifference);
+        return false;
+    }
+
+    return true;
+}
+
+// The quantized storage modes as the topology shader decodes them, against
+// the heights of a float texture of the same history. Sampled at the nearest
+// texel, the log modes would interpolate in their own domain otherwise.
+// Half floats have to be within their rounding, the log modes within a step
+static bool CheckDecoding()
+{
+    const unsigned int columns = 37, rows = 53;
+    const float logMin = -24.0f, logMax = -4.0f;
+    const size_t vertices = 6 * (size_t)(columns - 1) * (rows - 1);
+
+    std::vector<float> image((size_t)columns * rows);
+    std::mt19937 rng(19);
+    std::uniform_real_distribution<float> exponent(logMin, logMax);
+    for(float& value : image)
+        value = std::exp2(exponent(rng));
+
+    GLuint program = LinkProgram(TOPOLOGY_VERTEX_SHADER, TOPOLOGY_FRAGMENT_SHADER, { "height", "gl_Position" });
+    if(program == 0)
+        return false;
+
+    GLuint emptyArray;
+    glGenVertexArrays(1, &emptyArray);
+
+    auto heights = [&](TextureStorage storage)
+    {
+        HeightmapTexture heightmap(columns, rows, storage, false);
+        heightmap.SetLogRange(logMin, logMax);
+        heightmap.Upload(image.data(), 0, columns);
+
+        glActiveTexture(GL_TEXTURE0);
+        glBindTexture(GL_TEXTURE_2D, heightmap.GetTexture());
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+
+        SetUniforms(program, columns, rows, heightmap.GetFormat(), 5.0f);
+        return Capture(program, vertices, [&]()
+        {
+            glBindVertexArray(emptyArray);
+            glDrawArraysInstanced(GL_TRIANGLE_STRIP, 0, 2 * columns, rows - 1);
+            glBindVertexArray(0);
+        });
+    };
+
+    std::vector<float> expected = heights(TextureStorage::Float);
+    bool valid = true;
+
+    for(TextureStorage storage : { TextureStorage::Half, TextureStorage::Log16, TextureStorage::Log8 })
+    {
+        std::vector<float> actual = heights(storage);
+        if(actual.empty() || expected.empty())
+        {
+            valid = false;
+            continue;
+        }
+
+        unsigned int bits = (storage == TextureStorage::Log8) ? 8 : 16;
+        double step = (logMax - logMin) / (double)((1u << bits) - 1);
+
+        for(size_t i = 0; i < actual.size(); i += 5)
+        {
+            double reference = expected[i], height = actual[i];
+            bool close = (storage == TextureStorage::Half) ?
+                std::abs(height - reference) <= reference * std::exp2(-11.0) + std::exp2(-25.0) :
+                height > 0.0 && std::abs(std::log2(height) - std::log2(reference)) <= step + 1e-5;
+
+            if(!close)
+            {
+                std::printf("MISMATCH: %s texel decodes to %g instead of %g\n", GetStorageName(storage), height, reference);
+                valid = false;
+                break;
+            }
+        }
+    }
+
+    glDeleteVertexArrays(1, &emptyArray);
+    glDeleteProgram(program);
+    return valid;
+}
+
+bool BenchHeightmap(BenchReport& report)
+{
+    if(!report.IsEnabled("heightmap"))
+        return true;
+
+    HeadlessContext context;
+    if(!context.IsCurrent())
+    {
+        std::printf("  no headless GL 4.5 context, heightmap checks skipped\n");
+        return true;
+    }
+
+    GpuStall stall;
+    bool valid = stall.IsValid();
+
+    const TextureStorage storages[] = { TextureStorage::Float, TextureStorage::Half, TextureStorage::Log16, TextureStorage::Log8 };
+    for(TextureStorage storage : storages)
+    {
+        valid = CheckUploads(report, storage, false, stall) && valid;
+        valid = CheckUploads(report, storage, true, stall) && valid;
+    }
+
+    if(!stall.IsObservable())
+        std::printf("  the driver finishes every draw right away, declined uploads not checked\n");
+
+    valid = CheckGrid() && valid;
+    valid = CheckDecoding() && valid;
+
+    GLenum error = glGetError();
+    if(error != GL_NO_ERROR)
+    {
+        std::printf("MISMATCH: GL error %x\n", error);
+        valid = false;
+    }
+
+    return valid;
+}
@@ -0,0 +1,9 @@
+#pragma once
+
+#include "Bench.hpp"
+
+// Round trips through the heightmap texture and the topology shader on a
+// headless GL 4.5 context, e.g. Mesa's llvmpipe with EGL_PLATFORM=surfaceless.
+// Returns false on any mismatch, true without checking anything if no such
+// context can be created
+bool BenchHeightmap(BenchReport& report);
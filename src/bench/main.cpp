@@ -0,0 +1,1744 @@
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <complex>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <SDL2/SDL.h>
+
+#include "Bench.hpp"
+#ifdef VISUALIZER_BENCH_GL
+#include "Heightmap.hpp"
+#endif
+#include "FftPlan.hpp"
+#include "Stft.hpp"
+#include "Decimator.hpp"
+#include "SlidingDft.hpp"
+#include "BinningKernel.hpp"
+#include "AudioFile.hpp"
+#include "CaptureSource.hpp"
+#include "StreamingSource.hpp"
+#include "ColumnScheduler.hpp"
+#include "OfflineSpectrogram.hpp"
+#include "SpectrogramCache.hpp"
+#include "ImageWriter.hpp"
+#include "OfflineRender.hpp"
+#include "ValueRange.hpp"
+
+static std::vector<float> MakeSignal(size_t length)
+{
+    std::mt19937 rng(42);
+    std::uniform_real_distribution<float> noise(-0.1f, 0.1f);
+
+    std::vector<float> signal(length);
+    for(size_t i = 0; i < length; i++)
+        signal[i] = 0.5f * std::sin(2.0f * (float)M_PI * 440.0f * (float)i / 48000.0f) + noise(rng);
+
+    return signal;
+}
+
+static volatile float sink = 0.0f;
+
+// Complex and real transforms with every kernel set this machine supports
+static void BenchFft(BenchReport& report)
+{
+    if(!report.IsEnabled("fft"))
+        return;
+
+    SimdLevel levels[] = { SimdLevel::Scalar, SimdLevel::SSE2, SimdLevel::AVX2, SimdLevel::AVX512 };
+    for(SimdLevel level : levels)
+    {
+        if(level > DetectSimdLevel())
+            break;
+
+        const SimdKernels& kernels = GetSimdKernels(level);
+        for(size_t N = 256; N <= 65536; N <<= 2)
+        {
+            std::vector<float> signal = MakeSignal(N);
+            std::vector<std::complex<float>> input(signal.begin(), signal.end());
+            std::vector<std::complex<float>> output(N);
+
+            FftPlan complexPlan(N, kernels);
+            report.Run("fft", std::string("complex/") + kernels.name, N, (double)N, [&]()
+            {
+                complexPlan.Transform(input.data(), output.data());
+                sink = sink + output[1].real();
+            });
+
+            RealFftPlan realPlan(N, kernels);
+            report.Run("fft", std::string("real/") + kernels.name, N, (double)N, [&]()
+            {
+                realPlan.Transform(signal.data(), output.data());
+                sink = sink + output[1].real();
+            });
+        }
+    }
+}
+
+// Raw WAV payload to float conversion through a PcmView, as done when reading
+// a mapped AudioFile. Both ends of every format's range are checked, as are
+// frame offsets and the stereo downmix
+static bool BenchAudioConversion(BenchReport& report)
+{
+    if(!report.IsEnabled("audio_convert"))
+        return true;
+
+    struct Case { SampleFormat format; bool bigEndian; unsigned int channels; uint64_t frames, first; bool downmix; uint8_t raw[8]; float expected[2]; };
+    Case cases[] = {
+        { SampleFormat::U8, false, 1, 2, 0, false, { 0x00, 0xFF }, { -1.0f, 127.0f / 128.0f } },
+        { SampleFormat::S16, false, 1, 2, 0, false, { 0x00, 0x80, 0xFF, 0x7F }, { -1.0f, 32767.0f / 32768.0f } },
+        { SampleFormat::S16, true, 1, 2, 0, false, { 0x80, 0x00, 0x00, 0x01 }, { -1.0f, 1.0f / 32768.0f } },
+        { SampleFormat::S24, false, 1, 2, 0, false, { 0x00, 0x00, 0x80, 0xFF, 0xFF, 0x7F }, { -1.0f, 8388607.0f / 8388608.0f } },
+        { SampleFormat::S32, false, 1, 2, 0, false, { 0x00, 0x00, 0x00, 0x80, 0x00, 0x01, 0x00, 0x00 }, { -1.0f, 1.0f / 8388608.0f } },
+        { SampleFormat::S16, false, 2, 2, 1, false, { 0x00, 0x80, 0x00, 0x40, 0x00, 0xC0, 0x00, 0x20 }, { -0.5f, 0.25f } },
+        { SampleFormat::U8, false, 2, 2, 1, true, { 0x00, 0x80, 0xC0, 0xE0 }, { 0.625f } }
+    };
+
+    bool valid = true;
+    for(const Case& test : cases)
+    {
+        PcmView view{ test.raw, test.format, test.bigEndian, test.channels, test.frames };
+
+        size_t count = (size_t)(test.frames - test.first);
+        size_t values = test.downmix ? count : count * test.channels;
+        std::vector<float> converted(values);
+        ConvertPcm(view, test.first, count, converted.data(), test.downmix);
+
+        if(!std::equal(test.expected, test.expected + values, converted.begin()))
+        {
+            std::printf("MISMATCH: conversion of a %zu byte sample%s\n", GetBytesPerSample(test.format), test.downmix ? " with downmix" : "");
+            valid = false;
+        }
+    }
+
+    struct Format { SampleFormat format; bool bigEndian; const char* name; };
+    Format formats[] = {
+        { SampleFormat::U8, false, "u8" }, { SampleFormat::S16, false, "s16" }, { SampleFormat::S16, true, "s16be" },
+        { SampleFormat::S24, false, "s24" }, { SampleFormat::S32, false, "s32" }, { SampleFormat::F32, false, "f32" }
+    };
+
+    for(const Format& format : formats)
+    {
+        for(size_t samples = 1 << 14; samples <= (1 << 20); samples <<= 3)
+        {
+            std::vector<uint8_t> raw(samples * GetBytesPerSample(format.format), 0x40);
+            PcmView view{ raw.data(), format.format, format.bigEndian, 2, samples / 2 };
+
+            std::vector<float> converted(samples);
+            report.Run("audio_convert", format.name, samples, (double)samples, [&]()
+            {
+                ConvertPcm(view, 0, (size_t)view.frames, converted.data());
+                sink = sink + converted[0];
+            });
+        }
+    }
+
+    return valid;
+}
+
+// PCM conversion kernels of every level, for every format and byte order with
+// and without stereo downmix. Before timing, each kernel is checked to match
+// the scalar reference bit for bit, including odd lengths and misaligned input
+static bool BenchPcmConversion(BenchReport& report)
+{
+    if(!report.IsEnabled("pcm_convert"))
+        return true;
+
+    struct Format { SampleFormat format; const char* name; };
+    Format formats[] = {
+        { SampleFormat::U8, "u8" }, { SampleFormat::S16, "s16" }, { SampleFormat::S24, "s24" },
+        { SampleFormat::S32, "s32" }, { SampleFormat::F32, "f32" }
+    };
+
+    SimdLevel levels[] = { SimdLevel::Scalar, SimdLevel::SSE2, SimdLevel::AVX2, SimdLevel::AVX512 };
+    std::mt19937 rng(42);
+    bool exact = true;
+
+    for(const Format& format : formats)
+    {
+        size_t bytes = GetBytesPerSample(format.format);
+
+        // Random bit patterns cover every integer, floats stay finite so NaN
+        // payloads don't get in the way of the comparison
+        const size_t maxSamples = 1 << 20;
+        std::vector<uint8_t> raw(maxSamples * bytes);
+        for(uint8_t& byte : raw)
+            byte = (uint8_t)rng();
+
+        if(format.format == SampleFormat::F32)
+        {
+            std::vector<float> signal = MakeSignal(maxSamples);
+            std::memcpy(raw.data(), signal.data(), maxSamples * sizeof(float));
+        }
+
+        // The same samples one byte off their alignment
+        std::vector<uint8_t> shifted(raw.size() + 1);
+        std::copy(raw.begin(), raw.end(), shifted.begin() + 1);
+        const uint8_t* misaligned = shifted.data() + 1;
+
+        for(bool bigEndian : { false, true })
+        {
+            for(bool downmix : { false, true })
+            {
+                std::string variant = std::string(format.name) + (bigEndian ? "be" : "le") + (downmix ? "/downmix" : "");
+
+                for(SimdLevel level : levels)
+                {
+                    if(level > DetectSimdLevel())
+                        break;
+
+                    const SimdKernels& kernels = GetSimdKernels(level);
+                    for(size_t samples : { (size_t)0, (size_t)1, (size_t)2, (size_t)7, (size_t)33, (size_t)1027 })
+                    {
+                        std::vector<float> expected(samples), actual(samples);
+                        scalarKernels.ConvertPcm(misaligned, samples, format.format, bigEndian, downmix, expected.data());
+                        kernels.ConvertPcm(misaligned, samples, format.format, bigEndian, downmix, actual.data());
+
+                        if(std::memcmp(expected.data(), actual.data(), samples * sizeof(float)) != 0)
+                        {
+                            std::printf("MISMATCH: %s %s with %zu samples\n", kernels.name, variant.c_str(), samples);
+                            exact = false;
+                        }
+                    }
+
+                    std::vector<float> output(maxSamples);
+                    for(size_t samples = 1 << 14; samples <= maxSamples; samples <<= 3)
+                    {
+                        report.Run("pcm_convert", variant + "/" + kernels.name, samples, (double)samples, [&]()
+                        {
+                            kernels.ConvertPcm(raw.data(), samples, format.format, bigEndian, downmix, output.data());
+                            sink = sink + output[0];
+                        });
+                    }
+                }
+            }
+        }
+    }
+
+    return exact;
+}
+
+static void BenchNormalize(BenchReport& report)
+{
+    if(!report.IsEnabled("normalize"))
+        return;
+
+    for(size_t samples = 1 << 16; samples <= (1 << 22); samples <<= 2)
+    {
+        SDL_AudioSpec spec = {};
+        spec.channels = 2;
+        spec.freq = 48000;
+
+        AudioFile audio(MakeSignal(samples), spec);
+        report.Run("normalize", "AudioFile::Normalize", samples, (double)samples, [&]()
+        {
+            float first[2];
+            audio.Normalize();
+            audio.Read(0, 1, first);
+            sink = sink + first[0];
+        });
+    }
+}
+
+// Hop sized transfers through the capture ring, plus two checks: a producer
+// and a consumer thread moving a counting sequence must never lose or reorder
+// a value, and a capture device must deliver frames. The device defaults to
+// SDL's dummy driver, set SDL_AUDIODRIVER=disk to feed it from a file
+static bool BenchCapture(BenchReport& report)
+{
+    if(!report.IsEnabled("capture"))
+        return true;
+
+    bool valid = true;
+    for(size_t hop : { (size_t)64, (size_t)512, (size_t)4096 })
+    {
+        RingBuffer ring(1 << 16);
+        std::vector<float> block = MakeSignal(hop * 2);
+
+        report.Run("capture", "ring write+read", hop, (double)hop, [&]()
+        {
+            ring.Write(block.data(), block.size());
+            ring.Read(block.data(), block.size());
+            sink = sink + block[0];
+        });
+    }
+
+    {
+        const size_t total = 1 << 24;
+        RingBuffer ring(4096);
+
+        std::thread producer([&]()
+        {
+            float values[256];
+            for(size_t next = 0; next < total;)
+            {
+                size_t count = std::min<size_t>(1 + next % 256, total - next);
+                for(size_t i = 0; i < count; i++)
+                    values[i] = (float)((next + i) & 0xFFFFFF);
+
+                size_t written = 0;
+                while(written < count)
+                    written += ring.Write(values + written, count - written);
+
+                next += count;
+            }
+        });
+
+        float values[300];
+        size_t expected = 0;
+        while(expected < total)
+        {
+            size_t count = ring.Read(values, 1 + expected % 300);
+            for(size_t i = 0; i < count; i++, expected++)
+            {
+                if(values[i] != (float)(expected & 0xFFFFFF))
+                    valid = false;
+            }
+        }
+
+        producer.join();
+        if(!valid)
+            std::printf("MISMATCH: ring buffer lost or reordered values\n");
+    }
+
+    SDL_setenv("SDL_AUDIODRIVER", "dummy", 0);
+    if(SDL_InitSubSystem(SDL_INIT_AUDIO) != 0)
+    {
+        std::printf("Skipping capture device: %s\n", SDL_GetError());
+        return valid;
+    }
+
+    try
+    {
+        CaptureSource capture;
+        capture.Start();
+
+        // Half a second of input, drained in hops like the spectrogram does
+        std::vector<float> hop(512 * capture.GetChannels());
+        size_t frames = 0;
+        uint32_t start = SDL_GetTicks();
+        while(SDL_GetTicks() - start < 500)
+        {
+            if(capture.Read(hop.data(), 512))
+                frames += 512;
+            else
+                SDL_Delay(1);
+        }
+
+        capture.Stop();
+        std::printf("Capture (%s): %zu frames, %llu overruns, %llu underruns\n\n",
+            SDL_GetCurrentAudioDriver(), frames,
+            (unsigned long long)capture.GetOverruns(), (unsigned long long)capture.GetUnderruns());
+
+        if(frames == 0)
+            valid = false;
+    }
+    catch(const std::runtime_error& e)
+    {
+        std::printf("Skipping capture device: %s\n", e.what());
+    }
+
+    SDL_QuitSubSystem(SDL_INIT_AUDIO);
+    return valid;
+}
+
+// Writes a 16 bit stereo WAV of noise, big enough that the read-ahead has to
+// cycle through its chunks many times
+static std::string WriteTestWav(uint64_t frames)
+{
+    std::string path = (std::filesystem::temp_directory_path() / "visualizer_bench.wav").string();
+    std::ofstream file(path, std::ios::binary);
+
+    auto write16 = [&](uint16_t value) { file.put((char)(value & 0xFF)).put((char)(value >> 8)); };
+    auto write32 = [&](uint32_t value) { write16((uint16_t)(value & 0xFFFF)); write16((uint16_t)(value >> 16)); };
+
+    uint32_t dataSize = (uint32_t)(frames * 4);
+    file.write("RIFF", 4); write32(36 + dataSize); file.write("WAVE", 4);
+    file.write("fmt ", 4); write32(16); write16(1); write16(2); write32(48000); write32(48000 * 4); write16(4); write16(16);
+    file.write("data", 4); write32(dataSize);
+
+    std::mt19937 rng(42);
+    std::vector<uint16_t> samples(frames * 2);
+    for(uint16_t& sample : samples)
+        sample = (uint16_t)rng();
+
+    for(uint16_t sample : samples)
+        write16(sample);
+
+    return path;
+}
+
+// Hop sized sequential reads through the chunked read-ahead, checked against
+// the mapped file
+static bool BenchStreaming(BenchReport& report)
+{
+    if(!report.IsEnabled("streaming"))
+        return true;
+
+    const uint64_t frames = 1 << 23;
+    std::string path = WriteTestWav(frames);
+    bool valid = true;
+
+    {
+        AudioFile mapped(path);
+        StreamingSource stream(path, 1 << 14, 4);
+
+        std::vector<float> expected(4096 * 2), actual(4096 * 2);
+        for(uint64_t first = 0; first < frames; first += 4093)
+        {
+            size_t count = (size_t)std::min<uint64_t>(4093, frames - first);
+            mapped.Read(first, count, expected.data());
+
+            if(stream.Read(actual.data(), count) != count ||
+                std::memcmp(expected.data(), actual.data(), count * 2 * sizeof(float)) != 0)
+            {
+                std::printf("MISMATCH: streamed frames from %llu on differ from the mapped file\n", (unsigned long long)first);
+                valid = false;
+                break;
+            }
+        }
+    }
+
+    for(size_t hop : { (size_t)512, (size_t)4096 })
+    {
+        StreamingSource stream(path);
+        std::vector<float> block(hop * 2);
+
+        report.Run("streaming", "StreamingSource::Read", hop, (double)hop, [&]()
+        {
+            if(stream.Read(block.data(), hop) < hop)
+                stream.Seek(0);
+
+            sink = sink + block[0];
+        });
+
+        std::printf("  %llu read-ahead stalls\n", (unsigned long long)stream.GetStalls());
+    }
+
+    std::filesystem::remove(path);
+    return valid;
+}
+
+// Hop sized frame extraction by copy and by view from one decoded store that
+// is shared between several files. Both have to yield the same frames, and
+// normalizing must not take the views away. Columns with the gain applied by
+// the filterbank have to match those of samples scaled up front
+static bool BenchFrameViews(BenchReport& report)
+{
+    if(!report.IsEnabled("frame_views"))
+        return true;
+
+    const uint64_t frames = 1 << 20;
+    std::string path = WriteTestWav(frames);
+    bool valid = true;
+
+    {
+        AudioFile mapped(path);
+        mapped.Normalize();
+
+        std::shared_ptr<const SampleStore> store = mapped.Decode();
+        AudioFile decoded(store), shared(store);
+
+        // The same signal at a quarter of the level, which normalizing brings
+        // back up
+        FrameView all = store->GetFrames();
+        std::vector<float> samples(all.data, all.data + all.GetSamples());
+        for(float& sample : samples)
+            sample *= 0.25f;
+
+        AudioFile quiet(SampleStore::Create(samples, 2, 48000));
+        quiet.Normalize();
+
+        std::vector<float> buffer(4096 * 2);
+        if(quiet.GetGain() != 4.0f * mapped.GetGain() ||
+            quiet.GetFrames(7, 4096, buffer.data()) != quiet.GetView(7, 4096).data || quiet.GetView(7, 4096).IsEmpty() ||
+            mapped.GetFrames(7, 4096, buffer.data()) != buffer.data())
+        {
+            std::printf("MISMATCH: normalized files don't hand out views of float samples only\n");
+            valid = false;
+        }
+
+        std::vector<float> expected(4096 * 2);
+        for(uint64_t first = 0; first < frames; first += 4093)
+        {
+            size_t count = (size_t)std::min<uint64_t>(4093, frames - first);
+            mapped.Read(first, count, expected.data());
+
+            FrameView view = shared.GetView(first, count);
+            if(view.frames != count || view.data != decoded.GetView(first, count).data ||
+                std::memcmp(expected.data(), view.data, count * 2 * sizeof(float)) != 0)
+            {
+                std::printf("MISMATCH: viewed frames from %llu on differ from the mapped file\n", (unsigned long long)first);
+                valid = false;
+                break;
+            }
+        }
+
+        std::vector<float> scaled = samples;
+        for(float& sample : scaled)
+            sample *= quiet.GetGain();
+
+        StftSettings settings;
+        std::vector<ChannelMix> mixes = MakeChannelMixes(ChannelView::Separate, 2);
+        BinningKernel binning(FrequencyScale::Logarithmic, settings.fftSize, 48000.0f, 500, 50.0f, 24000.0f);
+        ThreadPool pool;
+
+        OfflineSpectrogram prescaled(
+            [&scaled](uint64_t first, size_t, float*) { return (const float*)scaled.data() + first * 2; },
+            frames, mixes, settings, binning, pool
+        );
+
+        binning.Scale(quiet.GetGain());
+        OfflineSpectrogram viewed(
+            [&quiet](uint64_t first, size_t count, float* buffer) { return quiet.GetFrames(first, count, buffer); },
+            frames, mixes, settings, binning, pool
+        );
+
+        size_t values = prescaled.GetColumns() * prescaled.GetRows();
+        ValueRange range = FindRange(prescaled.GetColumn(0), values);
+        for(size_t i = 0; i < values; i++)
+        {
+            if(std::abs(viewed.GetColumn(0)[i] - prescaled.GetColumn(0)[i]) > range.maximum * 1e-5f)
+            {
+                std::printf("MISMATCH: value %zu with the gain applied by the filterbank is %g instead of %g\n", i, viewed.GetColumn(0)[i], prescaled.GetColumn(0)[i]);
+                valid = false;
+                break;
+            }
+        }
+
+        const size_t hop = 512;
+        std::vector<float> block(hop * 2);
+        uint64_t position = 0;
+
+        report.Run("frame_views", "AudioFile::Read", hop, (double)hop, [&]()
+        {
+            position = (position + hop <= frames) ? position : 0;
+            decoded.Read(position, hop, block.data());
+            sink = sink + block[0];
+            position += hop;
+        });
+
+        report.Run("frame_views", "AudioFile::GetView", hop, (double)hop, [&]()
+        {
+            position = (position + hop <= frames) ? position : 0;
+            sink = sink + decoded.GetView(position, hop).data[0];
+            position += hop;
+        });
+    }
+
+    std::filesystem::remove(path);
+    return valid;
+}
+
+// Columns handed out for an audio clock that keeps time, runs late by many
+// batches, stays faster than a batch per call and runs backwards. Every
+// column up to the clock has to be handed out or skipped exactly once, and
+// the backlog never exceeds one batch
+static bool BenchScheduler(BenchReport& report)
+{
+    if(!report.IsEnabled("scheduler"))
+        return true;
+
+    const size_t hop = 64, batch = 16;
+    bool valid = true;
+
+    ColumnScheduler scheduler(hop, batch);
+    uint64_t handed = 0, skipped = 0;
+
+    auto advance = [&](const char* clock, uint64_t frames, uint64_t columns, uint64_t dropped)
+    {
+        size_t due = scheduler.Advance(frames);
+        handed += due;
+        skipped += scheduler.GetSkipped();
+
+        if(due != columns || scheduler.GetSkipped() != dropped || scheduler.GetBacklog() > batch)
+        {
+            std::printf("MISMATCH: %s clock at %llu frames handed out %zu columns and skipped %llu instead of %llu and %llu\n",
+                clock, (unsigned long long)frames, due, (unsigned long long)scheduler.GetSkipped(), (unsigned long long)columns, (unsigned long long)dropped);
+            valid = false;
+        }
+    };
+
+    auto expectTotal = [&](const char* clock, uint64_t frames, uint64_t origin)
+    {
+        if(handed + skipped + scheduler.GetBacklog() != (frames - origin) / hop || scheduler.GetTotalSkipped() != skipped)
+        {
+            std::printf("MISMATCH: %s clock lost track of the columns up to %llu frames\n", clock, (unsigned long long)frames);
+            valid = false;
+        }
+    };
+
+    // In time, a third of a hop per call
+    uint64_t clock = 0;
+    for(int i = 1; i <= 300; i++)
+    {
+        clock = (uint64_t)i * hop / 3;
+        advance("punctual", clock, (i % 3 == 0) ? 1 : 0, 0);
+    }
+
+    expectTotal("punctual", clock, 0);
+
+    // Ten batches late. One batch goes out, one stays due, the rest is
+    // skipped, and the backlog follows on the next calls
+    clock += 10 * batch * hop;
+    advance("late", clock, batch, 8 * batch);
+    advance("late", clock, batch, 0);
+    advance("late", clock, 0, 0);
+    expectTotal("late", clock, 0);
+
+    // A batch and a half per call. Once the backlog is full, the display
+    // stays within two batches of the clock rather than falling further behind
+    for(int i = 0; i < 100; i++)
+    {
+        clock += (batch + batch / 2) * hop;
+        advance("fast", clock, batch, (i < 2) ? 0 : batch / 2);
+    }
+
+    expectTotal("fast", clock, 0);
+
+    // Backwards starts over from there, without a column for the jump
+    clock /= 2;
+    handed = skipped = 0;
+    advance("backwards", clock, 0, 0);
+    advance("backwards", clock + 3 * hop + hop / 2, 3, 0);
+    advance("backwards", 0, 0, 0);
+    advance("backwards", hop, 1, 0);
+
+    handed = skipped = 0;
+    scheduler.Reset(5);
+    advance("reset", 5 + hop - 1, 0, 0);
+    advance("reset", 5 + 2 * hop, 2, 0);
+    expectTotal("reset", 5 + 2 * hop, 5);
+
+    ColumnScheduler timed(hop);
+    clock = 0;
+    report.Run("scheduler", "Advance", 1, 1.0, [&]()
+    {
+        clock += 3 * hop;
+        sink = sink + (float)timed.Advance(clock);
+    });
+
+    return valid;
+}
+
+// Whole-file columns of a stereo signal computed in blocks on the pool,
+// checked against one streaming Stft per channel mix. Every mix is analyzed
+// from the frames its block read, so the frames read must not depend on the
+// number of mixes
+static bool BenchOffline(BenchReport& report)
+{
+    if(!report.IsEnabled("offline"))
+        return true;
+
+    const uint64_t frames = 1 << 18;
+    const float sampleRate = 48000.0f;
+    std::vector<float> signal = MakeSignal((size_t)frames * 2);
+    for(size_t i = 1; i < signal.size(); i += 2)
+        signal[i] *= -0.5f;
+
+    ThreadPool pool;
+    bool valid = true;
+
+    for(size_t decimation : { (size_t)1, (size_t)4 })
+    {
+        StftSettings settings;
+        settings.decimation = decimation;
+
+        Stft probe(settings);
+        BinningKernel binning(FrequencyScale::Logarithmic, probe.GetTransformSize(), sampleRate / (float)decimation, 500, 50.0f, 5000.0f);
+
+        // Both kinds of readers: one converting into the buffer, one handing
+        // out the frames where they are
+        std::atomic<uint64_t> read(0);
+        auto reader = [&](uint64_t first, size_t count, float* buffer)
+        {
+            read += count;
+            std::copy(signal.data() + first * 2, signal.data() + (first + count) * 2, buffer);
+            return (const float*)buffer;
+        };
+
+        auto viewer = [&](uint64_t first, size_t, float*)
+        {
+            return (const float*)signal.data() + first * 2;
+        };
+
+        struct View { ChannelView view; const char* name; };
+        View views[] = { { ChannelView::Mixdown, "mixdown" }, { ChannelView::Separate, "separate" }, { ChannelView::MidSide, "mid_side" } };
+
+        uint64_t mixdownReads = 0;
+        for(const View& view : views)
+        {
+            std::vector<ChannelMix> mixes = MakeChannelMixes(view.view, 2);
+
+            read = 0;
+            OfflineSpectrogram computed(reader, frames, mixes, settings, binning, pool);
+            if(view.view == ChannelView::Mixdown)
+                mixdownReads = read;
+            else if(read != mixdownReads)
+            {
+                std::printf("MISMATCH: %zu mixes read %llu frames instead of %llu\n", mixes.size(), (unsigned long long)read, (unsigned long long)mixdownReads);
+                valid = false;
+            }
+
+            OfflineSpectrogram viewed(viewer, frames, mixes, settings, binning, pool);
+            if(std::memcmp(viewed.GetColumn(0), computed.GetColumn(0), computed.GetColumns() * computed.GetRows() * sizeof(float)) != 0)
+            {
+                std::printf("MISMATCH: columns analyzed from views differ from those of copied frames\n");
+                valid = false;
+            }
+
+            std::vector<float> expected(binning.GetRows());
+            for(size_t band = 0; band < mixes.size() && valid; band++)
+            {
+                Stft stft(settings, mixes[band]);
+                for(size_t column = 0; column < computed.GetColumns(); column++)
+                {
+                    stft.Push(signal.data() + column * settings.hopSize * 2, settings.hopSize);
+                    binning.Apply(stft.Analyze(), expected.data());
+
+                    const float* actual = computed.GetColumn(column) + band * binning.GetRows();
+                    if(std::memcmp(expected.data(), actual, expected.size() * sizeof(float)) != 0)
+                    {
+                        std::printf("MISMATCH: column %zu of mix %zu with decimation %zu differs from the streamed one\n", column, band, decimation);
+                        valid = false;
+                        break;
+                    }
+                }
+            }
+
+            std::string name = std::string(view.name) + "/decimation " + std::to_string(decimation);
+            report.Run("offline", name, frames, (double)frames, [&]()
+            {
+                OfflineSpectrogram spectrogram(reader, frames, mixes, settings, binning, pool);
+                sink = sink + spectrogram.GetColumn(0)[0];
+            });
+        }
+    }
+
+    return valid;
+}
+
+// Startup of a precomputed file with a cold and a warm cache. The mapped
+// columns are checked against the freshly computed ones
+static bool BenchCache(BenchReport& report)
+{
+    if(!report.IsEnabled("cache"))
+        return true;
+
+    const uint64_t frames = 1 << 21;
+    std::string path = WriteTestWav(frames);
+    std::string directory = (std::filesystem::temp_directory_path() / "visualizer_bench_cache").string();
+    bool valid = true;
+
+    {
+        AudioFile audio(path);
+        const float sampleRate = (float)audio.GetAudioSpec().freq;
+        std::vector<ChannelMix> mixes = MakeChannelMixes(ChannelView::Mixdown, audio.GetChannels());
+
+        StftSettings settings;
+        BinningKernel binning(FrequencyScale::Logarithmic, settings.fftSize, sampleRate, 2000, 50.0f, sampleRate / 2.0f);
+        ThreadPool pool;
+
+        auto read = [&audio](uint64_t first, size_t count, float* buffer) { return audio.GetFrames(first, count, buffer); };
+        auto describe = [&](const StftSettings& stft)
+        {
+            return SpectrogramCache::MakeHeader(
+                audio.GetContentHash(), sampleRate, audio.GetChannels(),
+                stft, ChannelView::Mixdown,
+                FrequencyScale::Logarithmic, 50.0f, sampleRate / 2.0f,
+                binning.GetRows()
+            );
+        };
+
+        OfflineSpectrogram computed(read, frames, mixes, settings, binning, pool);
+        SpectrogramCacheHeader header = describe(settings);
+
+        std::unique_ptr<SpectrogramCache> cache;
+        if(SpectrogramCache::Store(directory, header, computed))
+            cache = SpectrogramCache::Open(directory, header);
+
+        if(!cache)
+        {
+            std::printf("MISMATCH: failed to store and reopen the cache in \"%s\"\n", directory.c_str());
+            valid = false;
+        }
+        else if(cache->GetColumns() != computed.GetColumns() || cache->GetRows() != computed.GetRows() ||
+            std::memcmp(cache->GetColumn(0), computed.GetColumn(0), computed.GetColumns() * computed.GetRows() * sizeof(float)) != 0)
+        {
+            std::printf("MISMATCH: cached columns differ from the computed ones\n");
+            valid = false;
+        }
+
+        // Any other analysis parameter has to miss
+        StftSettings other = settings;
+        other.hopSize /= 2;
+        if(SpectrogramCache::Open(directory, describe(other)))
+        {
+            std::printf("MISMATCH: cache hit for a different hop size\n");
+            valid = false;
+        }
+
+        // Without a working cache there is no hit to time
+        if(cache)
+        {
+            report.Run("cache", "hash", frames, (double)frames, [&]()
+            {
+                sink = sink + (float)(audio.GetContentHash() & 1);
+            });
+
+            report.Run("cache", "miss", frames, (double)frames, [&]()
+            {
+                OfflineSpectrogram spectrogram(read, frames, mixes, settings, binning, pool);
+                sink = sink + spectrogram.GetColumn(spectrogram.GetColumns() - 1)[0];
+            });
+
+            report.Run("cache", "hit", frames, (double)frames, [&]()
+            {
+                std::unique_ptr<SpectrogramCache> hit = SpectrogramCache::Open(directory, describe(settings));
+                sink = sink + hit->GetColumn(hit->GetColumns() - 1)[0];
+            });
+        }
+    }
+
+    std::error_code error;
+    std::filesystem::remove_all(directory, error);
+    std::filesystem::remove(path, error);
+    return valid;
+}
+
+// Reads a PNG as written by WritePng16 back into 16 bit pixels. Every chunk
+// CRC, the stored block lengths and the Adler-32 are checked with bitwise
+// reference implementations rather than the writer's tables. Prints what is
+// wrong and returns false on anything unexpected
+static bool ReadPng16(const std::string& path, size_t& width, size_t& height, std::vector<uint16_t>& pixels)
+{
+    std::ifstream file(path, std::ios::binary);
+    std::vector<uint8_t> bytes((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+
+    auto read32 = [&](size_t offset) { return ((uint32_t)bytes[offset] << 24) | ((uint32_t)bytes[offset + 1] << 16) | ((uint32_t)bytes[offset + 2] << 8) | bytes[offset + 3]; };
+
+    static const uint8_t signature[8] = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n' };
+    if(bytes.size() < 8 || std::memcmp(bytes.data(), signature, 8) != 0)
+    {
+        std::printf("MISMATCH: \"%s\" has no PNG signature\n", path.c_str());
+        return false;
+    }
+
+    std::vector<uint8_t> zlib;
+    bool header = false, end = false;
+    for(size_t offset = 8; offset < bytes.size() && !end; )
+    {
+        if(offset + 12 > bytes.size() || offset + 12 + read32(offset) > bytes.size())
+        {
+            std::printf("MISMATCH: truncated chunk at byte %zu\n", offset);
+            return false;
+        }
+
+        uint32_t length = read32(offset);
+        std::string type(bytes.begin() + offset + 4, bytes.begin() + offset + 8);
+        const uint8_t* data = bytes.data() + offset + 8;
+
+        uint32_t crc = 0xFFFFFFFF;
+        for(size_t i = offset + 4; i < offset + 8 + length; i++)
+        {
+            crc ^= bytes[i];
+            for(int k = 0; k < 8; k++)
+                crc = (crc >> 1) ^ (0xEDB88320u & (0u - (crc & 1)));
+        }
+
+        if(~crc != read32(offset + 8 + length))
+        {
+            std::printf("MISMATCH: bad CRC on the %s chunk\n", type.c_str());
+            return false;
+        }
+
+        if(type == "IHDR")
+        {
+            width = read32(offset + 8);
+            height = read32(offset + 12);
+            if(length != 13 || data[8] != 16 || data[9] != 0 || data[10] != 0 || data[11] != 0 || data[12] != 0)
+            {
+                std::printf("MISMATCH: IHDR is not 16 bit grayscale\n");
+                return false;
+            }
+
+            header = true;
+        }
+        else if(type == "IDAT")
+            zlib.insert(zlib.end(), data, data + length);
+        else if(type == "IEND")
+            end = true;
+
+        offset += 12 + length;
+    }
+
+    if(!header || !end || zlib.size() < 6 || ((zlib[0] << 8) | zlib[1]) % 31 != 0 || (zlib[0] & 0x0F) != 8)
+    {
+        std::printf("MISMATCH: missing chunks or a bad zlib header\n");
+        return false;
+    }
+
+    // Stored blocks only: BFINAL, BTYPE 00, then LEN and its complement
+    std::vector<uint8_t> raw;
+    size_t position = 2;
+    for(bool last = false; !last; )
+    {
+        if(position + 5 > zlib.size() || (zlib[position] & 0x06) != 0)
+        {
+            std::printf("MISMATCH: expected a stored block at byte %zu of the zlib stream\n", position);
+            return false;
+        }
+
+        last = zlib[position] & 1;
+        uint16_t length = (uint16_t)(zlib[position + 1] | (zlib[position + 2] << 8));
+        uint16_t complement = (uint16_t)(zlib[position + 3] | (zlib[position + 4] << 8));
+        position += 5;
+
+        if((uint16_t)~length != complement || position + length > zlib.size())
+        {
+            std::printf("MISMATCH: bad stored block length at byte %zu of the zlib stream\n", position - 5);
+            return false;
+        }
+
+        raw.insert(raw.end(), zlib.begin() + position, zlib.begin() + position + length);
+        position += length;
+    }
+
+    uint32_t a = 1, b = 0;
+    for(uint8_t value : raw)
+    {
+        a = (a + value) % 65521;
+        b = (b + a) % 65521;
+    }
+
+    uint32_t adler = position + 4 == zlib.size() ? ((uint32_t)zlib[position] << 24) | ((uint32_t)zlib[position + 1] << 16) | ((uint32_t)zlib[position + 2] << 8) | zlib[position + 3] : 0;
+    if(position + 4 != zlib.size() || adler != ((b << 16) | a))
+    {
+        std::printf("MISMATCH: bad Adler-32 or trailing bytes in the zlib stream\n");
+        return false;
+    }
+
+    size_t rowBytes = 1 + 2 * width;
+    if(raw.size() != rowBytes * height)
+    {
+        std::printf("MISMATCH: %zu bytes of image data for %zux%zu pixels\n", raw.size(), width, height);
+        return false;
+    }
+
+    pixels.resize(width * height);
+    for(size_t y = 0; y < height; y++)
+    {
+        const uint8_t* row = raw.data() + y * rowBytes;
+        if(row[0] != 0)
+        {
+            std::printf("MISMATCH: row %zu uses filter type %d\n", y, row[0]);
+            return false;
+        }
+
+        for(size_t x = 0; x < width; x++)
+            pixels[y * width + x] = (uint16_t)((row[1 + 2 * x] << 8) | row[2 + 2 * x]);
+    }
+
+    return true;
+}
+
+// Headless rendering of a file. The PNG writer is read back for sizes that
+// fit one stored block, end exactly on a block boundary and span several
+// blocks. The raw output of RenderOffline has to match the columns of an
+// OfflineSpectrogram set up the same way, its PNG the same image scaled to
+// its range and flipped
+static bool BenchImage(BenchReport& report)
+{
+    if(!report.IsEnabled("image"))
+        return true;
+
+    std::filesystem::path directory = std::filesystem::temp_directory_path();
+    std::string pngPath = (directory / "visualizer_bench.png").string();
+    std::string rawPath = (directory / "visualizer_bench.raw").string();
+    bool valid = true;
+
+    // Rows of 16383 pixels are 32767 bytes, so two of them are one byte short
+    // of a full stored block and a third one crosses into the next block
+    const size_t sizes[][2] = { { 1, 1 }, { 3, 5 }, { 16383, 2 }, { 16383, 3 }, { 640, 480 } };
+    std::mt19937 rng(7);
+    for(const auto& size : sizes)
+    {
+        std::vector<uint16_t> pixels(size[0] * size[1]);
+        for(uint16_t& pixel : pixels)
+            pixel = (uint16_t)rng();
+
+        WritePng16(pngPath, pixels.data(), size[0], size[1]);
+
+        size_t width = 0, height = 0;
+        std::vector<uint16_t> decoded;
+        if(!ReadPng16(pngPath, width, height, decoded))
+            valid = false;
+        else if(width != size[0] || height != size[1] || decoded != pixels)
+        {
+            std::printf("MISMATCH: %zux%zu PNG reads back as different pixels\n", size[0], size[1]);
+            valid = false;
+        }
+    }
+
+    const uint64_t frames = 1 << 18;
+    std::string wavPath = WriteTestWav(frames);
+
+    OfflineRenderSettings settings;
+    settings.rows = 500;
+    settings.threads = 4;
+
+    RenderOffline(wavPath, rawPath, settings);
+    RenderOffline(wavPath, pngPath, settings);
+
+    {
+        AudioFile audio(wavPath);
+        audio.Normalize();
+
+        const float sampleRate = (float)audio.GetAudioSpec().freq;
+        std::vector<ChannelMix> mixes = MakeChannelMixes(settings.spectrogram.channelView, audio.GetChannels());
+
+        StftSettings stft = settings.spectrogram.stft;
+        stft.decimation = ChooseDecimation(stft, sampleRate, sampleRate / 2.0f);
+
+        Stft transform(stft);
+        BinningKernel binning(settings.spectrogram.scale, transform.GetTransformSize(), sampleRate / (float)stft.decimation,
+            settings.rows / mixes.size(), settings.spectrogram.minFrequency, sampleRate / 2.0f);
+        ThreadPool pool(2);
+
+        binning.Scale(audio.GetGain());
+        OfflineSpectrogram expected(
+            [&audio](uint64_t first, size_t count, float* buffer) { audio.Read(first, count, buffer); return (const float*)buffer; },
+            frames, mixes, stft, binning, pool
+        );
+
+        size_t width = expected.GetColumns(), height = expected.GetRows();
+        std::vector<float> image(width * height);
+        for(size_t x = 0; x < width; x++)
+            for(size_t y = 0; y < height; y++)
+                image[y * width + x] = expected.GetColumn(x)[y];
+
+        std::ifstream file(rawPath, std::ios::binary);
+        std::vector<float> rendered(image.size() + 1);
+        file.read(reinterpret_cast<char*>(rendered.data()), (std::streamsize)(rendered.size() * sizeof(float)));
+
+        if((size_t)file.gcount() != image.size() * sizeof(float) || std::memcmp(rendered.data(), image.data(), image.size() * sizeof(float)) != 0)
+        {
+            std::printf("MISMATCH: raw render differs from the OfflineSpectrogram columns\n");
+            valid = false;
+        }
+
+        ValueRange range = FindRange(image.data(), image.size());
+        float scale = (range.maximum > range.minimum) ? 65535.0f / (range.maximum - range.minimum) : 0.0f;
+
+        size_t pngWidth = 0, pngHeight = 0;
+        std::vector<uint16_t> pixels;
+        if(!ReadPng16(pngPath, pngWidth, pngHeight, pixels))
+            valid = false;
+        else if(pngWidth != width || pngHeight != height)
+        {
+            std::printf("MISMATCH: rendered PNG is %zux%zu instead of %zux%zu\n", pngWidth, pngHeight, width, height);
+            valid = false;
+        }
+        else
+        {
+            for(size_t i = 0; i < pixels.size(); i++)
+            {
+                size_t x = i % width, y = i / width;
+                float value = (image[(height - 1 - y) * width + x] - range.minimum) * scale;
+                if(std::abs((float)pixels[i] - value) > 0.5f + value * 1e-6f)
+                {
+                    std::printf("MISMATCH: rendered PNG pixel %zu,%zu is %d instead of %f\n", x, y, pixels[i], value);
+                    valid = false;
+                    break;
+                }
+            }
+        }
+    }
+
+    std::vector<uint16_t> pixels(2000 * 2000);
+    for(uint16_t& pixel : pixels)
+        pixel = (uint16_t)rng();
+
+    report.Run("image", "WritePng16", pixels.size(), (double)pixels.size(), [&]()
+    {
+        WritePng16(pngPath, pixels.data(), 2000, 2000);
+    });
+
+    std::error_code error;
+    std::filesystem::remove(pngPath, error);
+    std::filesystem::remove(rawPath, error);
+    std::filesystem::remove(wavPath, error);
+    return valid;
+}
+
+// Behavior of the gain control on 1 ms blocks: the envelope follows a level
+// step by 1 - 1/e after the attack and the release time, a rising gain ramps
+// linearly from the previous gain, and the peak detector never lets a sample
+// past the target
+static bool CheckGainControl()
+{
+    const float sampleRate = 48000.0f;
+    const size_t hop = 48;
+    bool valid = true;
+
+    // Alternating signs, so peak and RMS are both the level
+    std::vector<float> block(hop * 2);
+    auto fill = [&](float level)
+    {
+        for(size_t i = 0; i < block.size(); i++)
+            block[i] = (i % 4 < 2) ? level : -level;
+    };
+
+    auto expect = [&](const char* what, float actual, float expected)
+    {
+        if(std::abs(actual - expected) > 1e-4f * std::abs(expected))
+        {
+            std::printf("MISMATCH: gain control %s is %g instead of %g\n", what, actual, expected);
+            valid = false;
+        }
+    };
+
+    GainControlSettings settings;
+    GainControl gain(settings, sampleRate, 2);
+
+    size_t attackBlocks = (size_t)std::lround(settings.attack * sampleRate / (float)hop);
+    for(size_t i = 0; i < attackBlocks; i++)
+    {
+        fill(0.5f);
+        gain.Process(block.data(), hop);
+    }
+    expect("level after the attack time", gain.GetLevel(), 0.5f * (1.0f - std::exp(-1.0f)));
+
+    for(size_t i = 0; i < 1000; i++)
+    {
+        fill(0.5f);
+        gain.Process(block.data(), hop);
+    }
+    expect("settled level", gain.GetLevel(), 0.5f);
+
+    size_t releaseBlocks = (size_t)std::lround(settings.release * sampleRate / (float)hop);
+    for(size_t i = 0; i < releaseBlocks; i++)
+    {
+        fill(0.05f);
+        gain.Process(block.data(), hop);
+    }
+    expect("level after the release time", gain.GetLevel(), 0.05f + 0.45f * std::exp(-1.0f));
+
+    // The quieter input keeps raising the gain, one ramp per block
+    float previous = gain.GetGain();
+    fill(0.05f);
+    std::vector<float> input = block;
+    gain.Process(block.data(), hop);
+
+    float step = (gain.GetGain() - previous) / (float)hop;
+    if(step <= 0.0f)
+    {
+        std::printf("MISMATCH: gain control did not raise the gain of a quieter signal\n");
+        valid = false;
+    }
+
+    for(size_t i = 0; i < hop && valid; i++)
+        expect("ramped gain", block[2 * i] / input[2 * i], previous + step * (float)(i + 1));
+
+    // Bursts of random loudness, from silence to far above the target
+    std::mt19937 rng(42);
+    std::uniform_real_distribution<float> noise(-1.0f, 1.0f);
+    std::uniform_real_distribution<float> loudness(-6.0f, 2.0f);
+
+    GainControl peaks(settings, sampleRate, 2);
+    float largest = 0.0f;
+    for(size_t i = 0; i < 20000; i++)
+    {
+        float level = std::pow(10.0f, loudness(rng));
+        for(float& sample : block)
+            sample = level * noise(rng);
+
+        peaks.Process(block.data(), hop);
+        for(float sample : block)
+            largest = std::max(largest, std::abs(sample));
+    }
+
+    if(largest > settings.target * (1.0f + 1e-6f))
+    {
+        std::printf("MISMATCH: peak gain control let a sample reach %g, above the target %g\n", largest, settings.target);
+        valid = false;
+    }
+
+    return valid;
+}
+
+// The one-pass peak/RMS kernels of every level, checked against the scalar
+// kernel, and the per-block gain control on top of them
+static bool BenchStatistics(BenchReport& report)
+{
+    if(!report.IsEnabled("statistics"))
+        return true;
+
+    SimdLevel levels[] = { SimdLevel::Scalar, SimdLevel::SSE2, SimdLevel::AVX2, SimdLevel::AVX512 };
+    std::vector<float> signal = MakeSignal(1 << 20);
+    bool valid = true;
+
+    for(SimdLevel level : levels)
+    {
+        if(level > DetectSimdLevel())
+            break;
+
+        const SimdKernels& kernels = GetSimdKernels(level);
+        for(size_t count : { (size_t)0, (size_t)5, (size_t)37, (size_t)4099 })
+        {
+            float expectedPeak, expectedSum, peak, sum;
+            scalarKernels.Statistics(signal.data() + 1, count, &expectedPeak, &expectedSum);
+            kernels.Statistics(signal.data() + 1, count, &peak, &sum);
+
+            // Peaks are exact, sums only differ by rounding
+            if(peak != expectedPeak || std::abs(sum - expectedSum) > 1e-5f * expectedSum)
+            {
+                std::printf("MISMATCH: %s statistics of %zu samples\n", kernels.name, count);
+                valid = false;
+            }
+        }
+
+        for(size_t samples = 1 << 12; samples <= signal.size(); samples <<= 4)
+        {
+            report.Run("statistics", std::string("peak+rms/") + kernels.name, samples, (double)samples, [&]()
+            {
+                float peak, sum;
+                kernels.Statistics(signal.data(), samples, &peak, &sum);
+                sink = sink + peak + sum;
+            });
+        }
+    }
+
+    valid = CheckGainControl() && valid;
+
+    for(size_t hop : { (size_t)512, (size_t)4096 })
+    {
+        GainControl gain(GainControlSettings(), 48000.0f, 2);
+        std::vector<float> block(hop * 2);
+        size_t position = 0;
+
+        report.Run("statistics", "GainControl::Process", hop, (double)(hop * 2), [&]()
+        {
+            if(position + block.size() > signal.size())
+                position = 0;
+
+            std::copy(signal.begin() + position, signal.begin() + position + block.size(), block.begin());
+            gain.Process(block.data(), hop);
+            sink = sink + block[0];
+            position += block.size();
+        });
+    }
+
+    return valid;
+}
+
+static void BenchCalculateRange(BenchReport& report)
+{
+    if(!report.IsEnabled("calculate_range"))
+        return;
+
+    for(size_t scale = 1; scale <= 4; scale <<= 1)
+    {
+        size_t pixels = (200 * scale) * (2000 * scale);
+        std::vector<float> image = MakeSignal(pixels);
+
+        report.Run("calculate_range", "FindRange", pixels, (double)pixels, [&]()
+        {
+            ValueRange range = FindRange(image.data(), image.size());
+            sink = sink + range.maximum;
+        });
+    }
+}
+
+// Everything Spectrogram::Update does for one column except the texture
+// upload: push a hop, transform and bin straight into the column-major
+// history. The store alone is also timed against the strided row-major
+// layout Topology used to keep
+static void BenchColumn(BenchReport& report)
+{
+    if(!report.IsEnabled("column"))
+        return;
+
+    const size_t columns = 200, rows = 2000;
+    const float sampleRate = 48000.0f;
+
+    std::vector<float> signal = MakeSignal(1 << 20);
+    std::vector<float> image(columns * rows);
+    std::vector<float> column(rows);
+
+    for(size_t fftSize = 1024; fftSize <= 16384; fftSize <<= 1)
+    {
+        StftSettings settings;
+        settings.frameSize = fftSize / 4;
+        settings.hopSize = settings.frameSize / 4;
+        settings.fftSize = fftSize;
+
+        Stft stft(settings);
+        BinningKernel binning(FrequencyScale::Logarithmic, fftSize, sampleRate, rows, 50.0f, sampleRate / 2.0f);
+
+        size_t position = 0, strip = 0;
+        report.Run("column", "fft/logarithmic", fftSize, (double)settings.hopSize, [&]()
+        {
+            if(position + settings.hopSize > signal.size())
+                position = 0;
+
+            stft.Push(signal.data() + position, settings.hopSize);
+            binning.Apply(stft.Analyze(), image.data() + strip * rows);
+
+            position += settings.hopSize;
+            strip = (strip + 1) % columns;
+        });
+    }
+
+    size_t strip = 0;
+    report.Run("column", "store/row-major", rows, (double)rows, [&]()
+    {
+        for(unsigned int y = 0; y < rows; y++)
+            image[y * columns + strip] = column[y];
+
+        strip = (strip + 1) % columns;
+        sink = sink + image[strip];
+    });
+
+    report.Run("column", "store/column-major", rows, (double)rows, [&]()
+    {
+        std::copy(column.begin(), column.end(), image.begin() + strip * rows);
+
+        strip = (strip + 1) % columns;
+        sink = sink + image[strip];
+    });
+}
+
+// Decodes an IEEE half, to check the conversion kernels against
+static float FloatFromHalf(uint16_t half)
+{
+    int exponent = (half >> 10) & 0x1F;
+    float mantissa = (float)(half & 0x3FF);
+    float magnitude;
+
+    if(exponent == 0x1F)
+        magnitude = (half & 0x3FF) ? NAN : INFINITY;
+    else if(exponent == 0)
+        magnitude = std::ldexp(mantissa, -24);
+    else
+        magnitude = std::ldexp(mantissa + 1024.0f, exponent - 25);
+
+    return (half & 0x8000) ? -magnitude : magnitude;
+}
+
+// The conversions done when uploading a column to a half or log quantized
+// texture. Every finite half has to survive a round trip through float, the
+// vector kernels have to match the scalar ones bit for bit on random bit
+// patterns, log codes within one step of the exact logarithm
+static bool BenchQuantization(BenchReport& report)
+{
+    if(!report.IsEnabled("quantization"))
+        return true;
+
+    SimdLevel levels[] = { SimdLevel::Scalar, SimdLevel::SSE2, SimdLevel::AVX2, SimdLevel::AVX512 };
+    bool valid = true;
+
+    std::vector<float> halves;
+    for(uint32_t half = 0; half < 0x10000; half++)
+    {
+        if(((half >> 10) & 0x1F) != 0x1F)
+            halves.push_back(FloatFromHalf((uint16_t)half));
+    }
+
+    // Ties between two halves round to the even one, just above them up,
+    // past the largest half to infinity
+    struct Case { float value; uint16_t expected; };
+    Case cases[] = {
+        { 1.0f + std::ldexp(1.0f, -11), 0x3C00 }, { 1.0f + 3.0f * std::ldexp(1.0f, -11), 0x3C02 },
+        { std::nextafter(1.0f + std::ldexp(1.0f, -11), 2.0f), 0x3C01 }, { std::ldexp(1.0f, -25), 0x0000 },
+        { std::ldexp(3.0f, -26), 0x0001 }, { 65519.0f, 0x7BFF }, { 65520.0f, 0x7C00 }, { -INFINITY, 0xFC00 },
+        { NAN, 0x7E00 }, { 0.1f, 0x2E66 }
+    };
+
+    std::mt19937 rng(42);
+    std::vector<uint32_t> patterns(1 << 16);
+    for(uint32_t& pattern : patterns)
+        pattern = (uint32_t)rng();
+
+    std::vector<float> random(patterns.size());
+    std::memcpy(random.data(), patterns.data(), patterns.size() * sizeof(float));
+
+    std::vector<float> magnitudes = MakeSignal(1 << 20);
+    for(float& magnitude : magnitudes)
+        magnitude = std::abs(magnitude) * 0.01f;
+
+    // Below the floor, zero, negative, NaN and above the top code
+    const float logMin = -24.0f, logMax = -4.0f;
+    std::fill(magnitudes.begin(), magnitudes.begin() + 64, std::ldexp(1.0f, -30));
+    magnitudes[1] = 0.0f;
+    magnitudes[2] = -1.0f;
+    magnitudes[3] = NAN;
+    magnitudes[4] = INFINITY;
+
+    for(SimdLevel level : levels)
+    {
+        if(level > DetectSimdLevel())
+            break;
+
+        const SimdKernels& kernels = GetSimdKernels(level);
+
+        std::vector<uint16_t> converted(halves.size());
+        kernels.FloatToHalf(halves.data(), halves.size(), converted.data());
+        for(size_t i = 0; i < halves.size(); i++)
+        {
+            if(FloatFromHalf(converted[i]) != halves[i] || std::signbit(FloatFromHalf(converted[i])) != std::signbit(halves[i]))
+            {
+                std::printf("MISMATCH: %s round trip of half %g\n", kernels.name, halves[i]);
+                valid = false;
+                break;
+            }
+        }
+
+        for(const Case& test : cases)
+        {
+            uint16_t half;
+            kernels.FloatToHalf(&test.value, 1, &half);
+            if(half != test.expected)
+            {
+                std::printf("MISMATCH: %s converted %g to %04x instead of %04x\n", kernels.name, test.value, half, test.expected);
+                valid = false;
+            }
+        }
+
+        for(size_t count : { (size_t)3, (size_t)37, random.size() - 1 })
+        {
+            std::vector<uint16_t> expected(count), actual(count);
+            scalarKernels.FloatToHalf(random.data() + 1, count, expected.data());
+            kernels.FloatToHalf(random.data() + 1, count, actual.data());
+
+            if(expected != actual)
+            {
+                std::printf("MISMATCH: %s half conversion of %zu random floats\n", kernels.name, count);
+                valid = false;
+            }
+        }
+
+        for(unsigned int bits : { 8u, 16u })
+        {
+            const float maxCode = (float)((1u << bits) - 1);
+            const float scale = maxCode / (logMax - logMin);
+            const size_t count = 4099;
+
+            std::vector<uint8_t> output(count * bits / 8 + 1);
+            kernels.QuantizeLog(magnitudes.data(), count, logMin, scale, bits, output.data() + 1);
+
+            for(size_t i = 0; i < count; i++)
+            {
+                uint32_t code;
+                if(bits == 8)
+                    code = output[1 + i];
+                else
+                {
+                    uint16_t word;
+                    std::memcpy(&word, output.data() + 1 + 2 * i, sizeof(word));
+                    code = word;
+                }
+
+                float value = magnitudes[i];
+                float exact = (value > 0.0f && !std::isnan(value)) ? ((float)std::log2((double)value) - logMin) * scale : 0.0f;
+                exact = std::min(std::max(exact, 0.0f), maxCode);
+
+                if(std::abs((float)code - exact) > 1.0f)
+                {
+                    std::printf("MISMATCH: %s quantized %g to code %u of %u bits, expected %g\n", kernels.name, value, code, bits, exact);
+                    valid = false;
+                    break;
+                }
+            }
+        }
+
+        std::vector<uint16_t> words(magnitudes.size());
+        std::vector<uint8_t> bytes(magnitudes.size());
+        for(size_t samples = 2000; samples <= magnitudes.size(); samples <<= 3)
+        {
+            report.Run("quantization", std::string("half/") + kernels.name, samples, (double)samples, [&]()
+            {
+                kernels.FloatToHalf(magnitudes.data(), samples, words.data());
+                sink = sink + words[0];
+            });
+
+            report.Run("quantization", std::string("log16/") + kernels.name, samples, (double)samples, [&]()
+            {
+                kernels.QuantizeLog(magnitudes.data(), samples, logMin, 65535.0f / (logMax - logMin), 16, words.data());
+                sink = sink + words[0];
+            });
+
+            report.Run("quantization", std::string("log8/") + kernels.name, samples, (double)samples, [&]()
+            {
+                kernels.QuantizeLog(magnitudes.data(), samples, logMin, 255.0f / (logMax - logMin), 8, bytes.data());
+                sink = sink + bytes[0];
+            });
+        }
+    }
+
+    return valid;
+}
+
+// Cost of one column of the FFT and the sliding DFT path for different hop
+// sizes. The FFT path pays for a full transform per column, the sliding DFT
+// pays per sample and per displayed bin
+static void BenchSlidingDft(BenchReport& report)
+{
+    if(!report.IsEnabled("sliding_dft"))
+        return;
+
+    const size_t N = 2048;
+    std::vector<float> signal = MakeSignal(1 << 20);
+
+    for(size_t displayed : { (size_t)64, (size_t)256, N / 2 - 1 })
+    {
+        std::vector<size_t> bins;
+        for(size_t i = 0; i < displayed; i++)
+            bins.push_back(1 + i * (N / 2 - 2) / displayed);
+
+        for(size_t hop : { 1, 2, 4, 8, 16, 64, 256 })
+        {
+            StftSettings settings;
+            settings.frameSize = N;
+            settings.fftSize = N;
+            settings.hopSize = hop;
+
+            Stft stft(settings);
+            SlidingDft sdft(N, bins, WindowType::Hann, 4096);
+
+            size_t fftPos = 0, sdftPos = 0;
+            std::string suffix = "/" + std::to_string(displayed) + " bins";
+
+            report.Run("sliding_dft", "fft" + suffix, hop, (double)hop, [&]()
+            {
+                if(fftPos + hop > signal.size())
+                    fftPos = 0;
+
+                stft.Push(signal.data() + fftPos, hop);
+                sink = sink + stft.Analyze()[bins[0]];
+                fftPos += hop;
+            });
+
+            report.Run("sliding_dft", "sdft" + suffix, hop, (double)hop, [&]()
+            {
+                if(sdftPos + hop > signal.size())
+                    sdftPos = 0;
+
+                sdft.Push(signal.data() + sdftPos, hop);
+                sink = sink + sdft.Analyze()[bins[0]];
+                sdftPos += hop;
+            });
+        }
+    }
+}
+
+// Level in dB of a unit sine through a decimator. frequency is relative to
+// the decimated Nyquist frequency, the level is measured at wherever the tone
+// lands after decimation, aliased or not
+static double MeasureDecimatedTone(size_t factor, double frequency)
+{
+    const size_t outputs = 8192, settle = 64;
+    double omega = M_PI * frequency / (double)factor;
+
+    std::vector<float> input((outputs + settle) * factor);
+    for(size_t n = 0; n < input.size(); n++)
+        input[n] = (float)std::sin(omega * (double)n);
+
+    Decimator decimator(factor);
+    std::vector<float> output(input.size() / factor + 1);
+    size_t produced = decimator.Process(input.data(), input.size(), output.data());
+
+    double folded = std::fmod(omega * (double)factor, 2.0 * M_PI);
+    folded = (folded > M_PI) ? 2.0 * M_PI - folded : folded;
+
+    // Hann windowed correlation past the filter's settling time
+    size_t count = produced - settle;
+    std::complex<double> sum = 0.0;
+    double weights = 0.0;
+    for(size_t n = 0; n < count; n++)
+    {
+        double weight = 0.5 - 0.5 * std::cos(2.0 * M_PI * (double)n / (double)(count - 1));
+        sum += weight * (double)output[settle + n] * std::polar(1.0, -folded * (double)n);
+        weights += weight;
+    }
+
+    return 20.0 * std::log10(std::max(2.0 * std::abs(sum) / weights, 1e-30));
+}
+
+// One column of a display that ends at 4 kHz, with the full band transformed
+// and with the signal decimated ahead of a correspondingly smaller FFT. The
+// filter is checked first: flat within 0.001 dB up to 70% of the decimated
+// Nyquist frequency, the most Spectrogram lets a display use, and at least
+// 90 dB down from 1.3 times it on, where tones start to alias into that band
+static bool BenchDecimation(BenchReport& report)
+{
+    if(!report.IsEnabled("decimation"))
+        return true;
+
+    bool valid = true;
+    for(size_t factor : { (size_t)2, (size_t)4, (size_t)8 })
+    {
+        double ripple = 0.0, leakage = -400.0;
+        for(double frequency = 0.05; frequency <= 0.7001; frequency += 0.05)
+            ripple = std::max(ripple, std::abs(MeasureDecimatedTone(factor, frequency)));
+
+        for(double frequency = 1.3; frequency < std::min<double>((double)factor, 4.0); frequency += 0.05)
+            leakage = std::max(leakage, MeasureDecimatedTone(factor, frequency));
+
+        std::printf("Decimator/%zu: passband ripple %.5f dB, stopband %.1f dB\n", factor, ripple, leakage);
+        if(ripple > 0.001 || leakage > -90.0)
+        {
+            std::printf("MISMATCH: decimation filter of factor %zu out of spec\n", factor);
+            valid = false;
+        }
+    }
+
+    std::printf("\n");
+    std::vector<float> signal = MakeSignal(1 << 20);
+
+    for(size_t factor : { (size_t)2, (size_t)4, (size_t)8 })
+    {
+        Decimator decimator(factor);
+        std::vector<float> output(4096 / factor + 1);
+        size_t position = 0;
+
+        report.Run("decimation", "Decimator/" + std::to_string(factor), 4096, 4096.0, [&]()
+        {
+            if(position + 4096 > signal.size())
+                position = 0;
+
+            decimator.Process(signal.data() + position, 4096, output.data());
+            sink = sink + output[0];
+            position += 4096;
+        });
+    }
+
+    for(size_t factor : { (size_t)1, (size_t)4 })
+    {
+        StftSettings settings;
+        settings.decimation = factor;
+
+        Stft stft(settings);
+        BinningKernel binning(FrequencyScale::Logarithmic, stft.GetTransformSize(), 48000.0f / (float)factor, 2000, 50.0f, 4000.0f);
+        std::vector<float> column(2000);
+        size_t position = 0;
+
+        report.Run("decimation", "column/decimation " + std::to_string(factor), settings.fftSize, (double)settings.hopSize, [&]()
+        {
+            if(position + settings.hopSize > signal.size())
+                position = 0;
+
+            stft.Push(signal.data() + position, settings.hopSize);
+            binning.Apply(stft.Analyze(), column.data());
+            sink = sink + column[0];
+            position += settings.hopSize;
+        });
+    }
+
+    return valid;
+}
+
+// Cost of turning one spectrum into one image column. The lookup is the
+// nearest-bin Map() per row that the spectrogram used before the kernels
+static void BenchBinning(BenchReport& report)
+{
+    if(!report.IsEnabled("binning"))
+        return;
+
+    const size_t rows = 2000;
+    const float sampleRate = 44100.0f;
+    std::vector<float> column(rows);
+
+    for(size_t fftSize = 2048; fftSize <= 32768; fftSize <<= 2)
+    {
+        std::vector<float> spectrum = MakeSignal(fftSize / 2 + 1);
+
+        report.Run("binning", "Map lookup", fftSize, (double)rows, [&]()
+        {
+            float lowest = 50.0f / (sampleRate / (float)fftSize);
+            float step = ((float)(fftSize / 2) - lowest) / (float)rows;
+
+            for(size_t y = 0; y < rows; y++)
+                column[y] = spectrum[(size_t)((float)y * step + lowest)];
+
+            sink = sink + column[rows / 2];
+        });
+
+        const char* names[] = { "linear", "logarithmic", "mel", "bark" };
+        FrequencyScale scales[] = { FrequencyScale::Linear, FrequencyScale::Logarithmic, FrequencyScale::Mel, FrequencyScale::Bark };
+
+        for(size_t i = 0; i < 4; i++)
+        {
+            BinningKernel kernel(scales[i], fftSize, sampleRate, rows, 50.0f, sampleRate / 2.0f);
+            report.Run("binning", names[i], fftSize, (double)rows, [&]()
+            {
+                kernel.Apply(spectrum.data(), column.data());
+                sink = sink + column[rows / 2];
+            });
+        }
+    }
+}
+
+int main(int argc, char** argv)
+{
+    std::string jsonPath;
+    std::string filter;
+    double minSeconds = 0.2;
+
+    for(int i = 1; i < argc; i++)
+    {
+        if(std::strcmp(argv[i], "--json") == 0 && i + 1 < argc)
+            jsonPath = argv[++i];
+        else if(std::strcmp(argv[i], "--filter") == 0 && i + 1 < argc)
+            filter = argv[++i];
+        else if(std::strcmp(argv[i], "--quick") == 0)
+            minSeconds = 0.02;
+        else
+        {
+            std::printf("Usage: %s [--json <file>] [--filter <group>] [--quick]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    std::printf("Kernels: %s\n\n", GetSimdKernels().name);
+    BenchReport report(minSeconds, filter);
+
+    BenchFft(report);
+    bool exact = BenchAudioConversion(report);
+    exact = BenchPcmConversion(report) && exact;
+    exact = BenchCapture(report) && exact;
+    exact = BenchStreaming(report) && exact;
+    exact = BenchFrameViews(report) && exact;
+    exact = BenchScheduler(report) && exact;
+    exact = BenchOffline(report) && exact;
+    exact = BenchCache(report) && exact;
+    exact = BenchImage(report) && exact;
+    BenchNormalize(report);
+    exact = BenchStatistics(report) && exact;
+    BenchCalculateRange(report);
+    BenchColumn(report);
+    exact = BenchQuantization(report) && exact;
+    BenchSlidingDft(report);
+    exact = BenchDecimation(report) && exact;
+    BenchBinning(report);
+#ifdef VISUALIZER_BENCH_GL
+    exact = BenchHeightmap(report) && exact;
+#endif
+
+    if(!jsonPath.empty() && !report.WriteJson(jsonPath))
+    {
+        std::printf("Failed to write \"%s\"\n", jsonPath.c_str());
+        return 1;
+    }
+
+    return exact ? 0 : 1;
+}
\ No newline at end of file
@@ -1,13 +1,63 @@
 #include <iostream>
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
 #include "Application.hpp"
+#include "OfflineRender.hpp"
 
 int main(int argc, char** argv)
 {
+	// --capture visualizes the default recording device instead of the file,
+	// --stream reads the file in chunks instead of mapping it.
+	// --offline <input> <output> renders a whole file to an image without
+	// ever opening a window, --threads and --rows tune that render
+	InputMode input = InputMode::File;
+	std::string offlineInput, offlineOutput;
+	OfflineRenderSettings offline;
+	for (int i = 1; i < argc; i++)
+	{
+		if (std::strcmp(argv[i], "--capture") == 0)
+			input = InputMode::Capture;
+		else if (std::strcmp(argv[i], "--stream") == 0)
+			input = InputMode::Stream;
+		else if (std::strcmp(argv[i], "--offline") == 0 && i + 2 < argc)
+		{
+			offlineInput = argv[++i];
+			offlineOutput = argv[++i];
+		}
+		else if (std::strcmp(argv[i], "--threads") == 0 && i + 1 < argc)
+			offline.threads = (size_t)std::max(std::atoi(argv[++i]), 1);
+		else if (std::strcmp(argv[i], "--rows") == 0 && i + 1 < argc)
+			offline.rows = (unsigned int)std::max(std::atoi(argv[++i]), 1);
+		else if (std::strcmp(argv[i], "--offline") == 0 || std::strcmp(argv[i], "--threads") == 0 || std::strcmp(argv[i], "--rows") == 0)
+		{
+			std::cerr << "Missing value for " << argv[i] << "\n\n"
+				<< "Usage: " << argv[0] << " [--capture | --stream]\n"
+				<< "       " << argv[0] << " --offline <input> <output> [--threads <n>] [--rows <n>]" << std::endl;
+			return 1;
+		}
+	}
+
+	if (!offlineInput.empty())
+	{
+		try
+		{
+			RenderOffline(offlineInput, offlineOutput, offline);
+		}
+		catch (const std::runtime_error& err)
+		{
+			std::cerr << "Offline render failed\n\n" << err.what() << std::endl;
+			return 1;
+		}
+
+		return 0;
+	}
+
 	Application& app = Application::Instance();
 
 	try
 	{
-		app.Init(1280, 720, "Visualizer");
+		app.Init(1280, 720, "Visualizer", input);
 	}
 	catch (const std::runtime_error& err)
 	{